@@ -33,6 +33,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "cinder/gl/GlslProg.h"
 #include "cinder/gl/Texture.h"
 
+#include <functional>
+#include <future>
+#include <mutex>
 #include <unordered_map>
 
 typedef struct FT_FaceRec_*  FT_Face;
@@ -42,6 +45,10 @@ namespace cinder { namespace gl {
 class SdfText;
 using SdfTextRef = std::shared_ptr<SdfText>;
 
+namespace detail {
+struct GlyphQuadBatch;
+} // namespace detail
+
 //! \class SdfText
 //!
 //!
@@ -66,11 +73,34 @@ public:
 		int32_t			getTextureHeight() const { return mTextureSize.y; }
 		//! Returns the size of the textures created internally for glyphs. Default \c 1024x1024
 		const ivec2&	getTextureSize() const { return mTextureSize; }
+		//! Sets whether a static atlas picks the power of two page size up to maxTextureSize() that holds its glyphs in the fewest pages with the fewest unused texels, instead of using textureSize(). Default \c false
+		Format&			autoTextureSize( bool value = true ) { mAutoTextureSize = value; return *this; }
+		//! Returns whether a static atlas picks its page size. Default \c false
+		bool			getAutoTextureSize() const { return mAutoTextureSize; }
+		//! Sets the largest page size autoTextureSize() may pick, further limited by \c GL_MAX_TEXTURE_SIZE. Default \c 4096x4096
+		Format&			maxTextureSize( const ivec2 &value ) { mMaxTextureSize = value; return *this; }
+		//! Returns the largest page size autoTextureSize() may pick. Default \c 4096x4096
+		const ivec2&	getMaxTextureSize() const { return mMaxTextureSize; }
 
 		Format&			sdfScale( const vec2 &value ) { mSdfScale = value; return *this; }
 		Format&			sdfScale( float value ) { return sdfScale( vec2( value ) ); }
 		const vec2&		getSdfScale() const { return mSdfScale; }
 
+		//! Sets the scale of a high resolution atlas that atlases with a lower sdfScale() are derived from by downsampling instead of generating their glyphs. Formats sharing the pyramid scale share that atlas, which keeps its compressed pages. Ignored for adaptive and dynamic atlases. Default \c 0 (disabled)
+		Format&			pyramidSdfScale( const vec2 &value ) { mPyramidSdfScale = value; return *this; }
+		Format&			pyramidSdfScale( float value ) { return pyramidSdfScale( vec2( value ) ); }
+		//! Returns the scale of the atlas lower scales are derived from. Default \c 0 (disabled)
+		const vec2&		getPyramidSdfScale() const { return mPyramidSdfScale; }
+
+		//! Sets whether each glyph of a static atlas is generated with its own scale within sdfScaleRange(), picked from its outline complexity, instead of sdfScale(). Glyphs are packed tightly. Default \c false
+		Format&			adaptiveSdfScale( bool value = true ) { mAdaptiveSdfScale = value; return *this; }
+		//! Returns whether each glyph is generated with its own scale picked from its outline complexity. Default \c false
+		bool			getAdaptiveSdfScale() const { return mAdaptiveSdfScale; }
+		//! Sets the range of per glyph scales used with adaptiveSdfScale(). Default \c 1 to \c 3
+		Format&			sdfScaleRange( float minScale, float maxScale ) { mSdfScaleRange = vec2( std::min( minScale, maxScale ), std::max( minScale, maxScale ) ); return *this; }
+		float			getMinSdfScale() const { return mSdfScaleRange.x; }
+		float			getMaxSdfScale() const { return mSdfScaleRange.y; }
+
 		Format&			sdfPadding( const ivec2 &value ) { mSdfScale = value; return *this; }
 		const ivec2&	getSdfPadding() const { return mSdfPadding; }
 
@@ -83,13 +113,55 @@ public:
 		Format&			sdfTileSpacing( const ivec2& value ) { mSdfTileSpacing = value; return *this; }
 		const ivec2&	getSdfTileSpacing() const { return mSdfTileSpacing; }
 
+		//! Sets whether the atlas pages are stored as layers of a single 2D texture array, which draws any number of pages with one draw call. Ignored on ES 2. Default \c false
+		Format&			textureArray( bool value = true ) { mTextureArray = value; return *this; }
+		//! Returns whether the atlas pages are stored as layers of a single 2D texture array. Default \c false
+		bool			getTextureArray() const { return mTextureArray; }
+
+		//! Sets whether a compressed CPU copy of every atlas page is kept resident alongside the textures. Default \c false
+		Format&			keepCompressedPages( bool value = true ) { mKeepCompressedPages = value; return *this; }
+		//! Returns whether a compressed CPU copy of every atlas page is kept resident alongside the textures. Default \c false
+		bool			getKeepCompressedPages() const { return mKeepCompressedPages; }
+
+		//! Sets whether glyphs are rendered into the atlas on demand when drawn instead of up front. Once the atlas reaches maxPages() the least recently drawn glyphs are evicted to make room. Default \c false
+		Format&			dynamic( bool value = true ) { mDynamic = value; return *this; }
+		//! Returns whether glyphs are rendered into the atlas on demand when drawn. Default \c false
+		bool			getDynamic() const { return mDynamic; }
+		//! Sets the maximum number of pages of a dynamic atlas, which bounds its texture memory. Default \c 2
+		Format&			maxPages( uint32_t value ) { mMaxPages = std::max<uint32_t>( value, 1 ); return *this; }
+		//! Returns the maximum number of pages of a dynamic atlas. Default \c 2
+		uint32_t		getMaxPages() const { return mMaxPages; }
+
+		//! Sets whether the atlas is split by Unicode block (Basic Latin, Latin-1, Greek, Cyrillic, CJK in ranges of 1024 ideographs...) and each block is generated, or loaded from the disk cache, the first time text uses one of its characters. The characters passed at creation aren't rendered up front. Blocks are static atlases cached on their own, textureArray() and autoTextureSize() are ignored. Ignored for dynamic atlases. Default \c false
+		Format&			unicodeBlocks( bool value = true ) { mUnicodeBlocks = value; return *this; }
+		//! Returns whether the atlas is split by Unicode block, loaded as text first uses them. Default \c false
+		bool			getUnicodeBlocks() const { return mUnicodeBlocks; }
+
+		//! Sets the priority of characters, explicitly or as their expected frequency. The glyphs of higher priority characters are put together on the first pages of a static atlas, so common text draws from fewer textures. The pages are generated in order and the atlas is published before the first one, so these glyphs draw while the others are still being generated. Other characters have priority \c 0. Default empty (glyph index order)
+		Format&			glyphPriorities( const std::unordered_map<uint32_t, float> &charPriorities ) { mGlyphPriorities = charPriorities; return *this; }
+		//! Sets the priority of the characters of \a utf8Text, such as the strings about to be drawn, to how often they occur in it
+		Format&			glyphPriorities( const std::string &utf8Text );
+		//! Returns the priority of characters by UTF-32 code point. Default empty
+		const std::unordered_map<uint32_t, float>&	getGlyphPriorities() const { return mGlyphPriorities; }
+
 	private:
 		ivec2			mTextureSize = ivec2( 1024 );
+		bool			mAutoTextureSize = false;
+		ivec2			mMaxTextureSize = ivec2( 4096 );
 		vec2			mSdfScale = vec2( 2.0f );
+		vec2			mPyramidSdfScale = vec2( 0.0f );
 		ivec2			mSdfPadding = vec2( 2.0f );
 		float			mSdfRange = 4.0f;
 		float			mSdfAngle = 3.0f;
 		ivec2			mSdfTileSpacing = ivec2( 1 );
+		bool			mTextureArray = false;
+		bool			mAdaptiveSdfScale = false;
+		vec2			mSdfScaleRange = vec2( 1.0f, 3.0f );
+		bool			mKeepCompressedPages = false;
+		bool			mDynamic = false;
+		uint32_t		mMaxPages = 2;
+		bool			mUnicodeBlocks = false;
+		std::unordered_map<uint32_t, float>	mGlyphPriorities;
 	};
 
 	// ---------------------------------------------------------------------------------------------
@@ -125,6 +197,11 @@ public:
 		//! Sets the scale at which the type is rendered. 2 is double size. Default \c 1
 		DrawOptions&	scale( float sc ) { mScale = sc; return *this; }
 
+		//! Returns the point size the text is laid out and drawn at, \c 0 for the size of the font. Default \c 0
+		float			getSize() const { return mSize; }
+		//! Sets the point size the text is laid out and drawn at, so that one SdfText serves every size without creating a Font per size. Metrics are scaled from the size of the font. Default \c 0 (size of the font)
+		DrawOptions&	size( float value ) { mSize = value; return *this; }
+
 		//! Returns the leading (aka line gap) used adjust the line height when wrapping. Default \c 0
 		float			getLeading() const { return mLeading; }
 		//! Sets the leading (aka line gap) used adjust the line height when wrapping. Default \c 0
@@ -151,6 +228,7 @@ public:
 	  protected:
 		bool			mClipHorizontal, mClipVertical, mPixelSnap, mLigate;
 		float			mScale = 2.0;
+		float			mSize = 0.0f;
 		float			mLeading = 0.0f;
 		bool			mPremultiply = false;
 		float			mGamma = 2.2f;
@@ -174,6 +252,25 @@ public:
 		using GlyphMetricsMap = std::map<SdfText::Font::Glyph, SdfText::Font::GlyphMetrics>;
 		using GlyphMeasures = std::vector<std::pair<SdfText::Font::Glyph, vec2>>;
 
+		//! \class LockedFace
+		//! FreeType face with the size of a font active. Fonts of other sizes and the atlases share the face, so it's locked against use from other threads for as long as this is held.
+		class LockedFace {
+		public:
+			LockedFace() {}
+
+			FT_Face		get() const { return mFace; }
+			FT_Face		operator->() const { return mFace; }
+			explicit operator bool() const { return nullptr != mFace; }
+
+		private:
+			LockedFace( FT_Face face, std::unique_lock<std::recursive_mutex> &&lock ) : mFace( face ), mLock( std::move( lock ) ) {}
+
+			FT_Face									mFace = nullptr;
+			std::unique_lock<std::recursive_mutex>	mLock;
+
+			friend class SdfText::FontData;
+		};
+
 		Font() {}
 		Font( const std::string &name, float size );
 		Font( DataSourceRef dataSource, float size );
@@ -196,17 +293,79 @@ public:
 		Glyph					getGlyphChar( char utf8Char ) const;
 		std::vector<Glyph>		getGlyphs( const std::string &utf8Chars ) const;
 
-		FT_Face					getFace() const;
+		//! Returns the face with the size of this font current on it, locked until the result goes away. Don't keep the face past that.
+		LockedFace				getFace() const;
 
 		static const std::vector<std::string>&	getNames( bool forceRefresh = false );
 		static SdfText::Font					getDefault();
+		//! Adds \a directory to the directories searched for fonts by name on Linux, next to the standard ones, and rescans them. Directories that haven't changed since the last scan are read from the font index.
+		static void								addFontDirectory( const fs::path &directory );
 
 	private:
 		float					mSize;
 		FontDataRef				mData;
 		std::string				mName;
 		size_t					mNumGlyphs = 0;
-		void					loadFontData( const ci::DataSourceRef &dataSource );
+		void					loadFontData( const ci::DataSourceRef &dataSource, uint32_t faceIndex = 0 );
+
+		friend class SdfText;
+	};
+
+	// ---------------------------------------------------------------------------------------------
+
+	//! \class AsyncResult
+	//! SdfText being created in the background by createAsync(). Poll isReady() once per frame on the GL thread.
+	class AsyncResult {
+	public:
+		//! Returns true once the SdfText is built, which for a new static atlas is as soon as it's laid out. Its pages follow in priority order, see Format::glyphPriorities(). The first call that finds it built on the GL thread uploads its atlas pages, so drawing it doesn't stall. Rethrows the exception if it couldn't be created.
+		bool		isReady();
+		//! Returns the SdfText, waiting for it if it isn't built yet. Rethrows the exception if it couldn't be created.
+		SdfTextRef	get();
+
+	private:
+		AsyncResult( const std::shared_future<SdfTextRef> &future ) : mFuture( future ) {}
+
+		std::shared_future<SdfTextRef>	mFuture;
+		SdfTextRef						mResult;
+
+		friend class SdfText;
+	};
+
+	using AsyncResultRef = std::shared_ptr<AsyncResult>;
+
+	//! \struct PrewarmEntry
+	//! Atlas to build ahead of the first create() that needs it, see prewarm()
+	struct PrewarmEntry {
+		PrewarmEntry() {}
+		PrewarmEntry( const std::string &aFontName, float aFontSize, const Format &aFormat = Format(), const std::string &aUtf8Chars = SdfText::defaultChars(), int aPriority = 0 )
+			: fontName( aFontName ), fontSize( aFontSize ), format( aFormat ), utf8Chars( aUtf8Chars ), priority( aPriority ) {}
+		PrewarmEntry( const SdfText::Font &aFont, const Format &aFormat = Format(), const std::string &aUtf8Chars = SdfText::defaultChars(), int aPriority = 0 )
+			: font( aFont ), format( aFormat ), utf8Chars( aUtf8Chars ), priority( aPriority ) {}
+
+		//! Loaded by name in the background unless \c font is set
+		std::string			fontName;
+		float				fontSize = 32.0f;
+		SdfText::Font		font;
+		Format				format;
+		//! Characters of the strings the atlas is built for
+		std::string			utf8Chars = SdfText::defaultChars();
+		//! Glyph indices built next to \c utf8Chars, such as the output of a text shaper
+		std::vector<SdfText::Font::Glyph>	glyphs;
+		//! Entries with a higher priority are built first. Default \c 0
+		int					priority = 0;
+	};
+
+	//! \struct PrewarmProgress
+	//! Entries of every prewarm() so far
+	struct PrewarmProgress {
+		size_t		numEntries = 0;
+		//! Entries that were built or failed
+		size_t		numFinished = 0;
+		size_t		numFailed = 0;
+
+		bool		isDone() const { return numFinished >= numEntries; }
+		//! Returns the fraction of finished entries, \c 1 if there are none
+		float		getFraction() const { return ( numEntries > 0 ) ? static_cast<float>( numFinished ) / static_cast<float>( numEntries ) : 1.0f; }
 	};
 
 	// ---------------------------------------------------------------------------------------------
@@ -215,6 +374,17 @@ public:
 
 	//! Creates a new TextureFontRef with font \a font, ensuring that glyphs necessary to render \a supportedChars are renderable, and format \a format
 	static SdfTextRef		create( const SdfText::Font &font, const Format &format = Format(), const std::string &utf8Chars = SdfText::defaultChars() );
+	//! Creates a new SdfTextRef with font \a font whose atlas holds the glyph indices \a glyphs, such as the output of a text shaper. Unlike characters, glyph indices also reach ligatures and alternates that have no character map entry. A dynamic atlas renders \a glyphs right away.
+	static SdfTextRef		create( const SdfText::Font &font, const Format &format, const std::vector<SdfText::Font::Glyph> &glyphs );
+	//! Creates one SdfText per font in \a fonts whose glyphs are packed into shared texture pages, so that text mixing these faces draws from the same textures. All fonts use \a format and \a utf8Chars.
+	static std::vector<SdfTextRef>	createShared( const std::vector<SdfText::Font> &fonts, const Format &format = Format(), const std::string &utf8Chars = SdfText::defaultChars() );
+	//! Creates a new SdfTextRef like create() on a background thread and returns right away. The atlas is generated or loaded off the calling thread, only its pages are uploaded on the GL thread, see AsyncResult. 
+	//! The result is ready once a new static atlas is laid out, its glyphs draw as their pages are generated.
+	static AsyncResultRef	createAsync( const SdfText::Font &font, const Format &format = Format(), const std::string &utf8Chars = SdfText::defaultChars() );
+	//! Loads the fonts and builds the atlases of \a manifest on background threads in priority order, so the first create() of each is a cache hit. Returns an AsyncResult per entry in manifest order, the atlases stay cached at least as long as they're held.
+	static std::vector<AsyncResultRef>	prewarm( const std::vector<PrewarmEntry> &manifest );
+	//! Returns how many of the entries passed to prewarm() are finished
+	static PrewarmProgress	getPrewarmProgress();
 
 	//! Draws string \a str at baseline \a baseline with DrawOptions \a options
 	void	drawString( const std::string &str, const vec2 &baseline, const DrawOptions &options = DrawOptions() );
@@ -224,10 +394,12 @@ public:
 	void	drawStringWrapped( const std::string &str, const Rectf &fitRect, const vec2 &offset = vec2(), const DrawOptions &options = DrawOptions() );
 	//! Draws the glyphs in \a glyphMeasures at baseline \a baseline with DrawOptions \a options. \a glyphMeasures is a vector of pairs of glyph indices and offsets for the glyph baselines
 	void	drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const vec2 &baseline, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
+	//! Makes sure the glyph indices \a glyphs are in the atlas. A dynamic atlas renders the missing ones now instead of on the first draw, evicting the least recently drawn glyphs if it's full. A Format::unicodeBlocks() atlas loads their blocks. Returns the number of \a glyphs that can be drawn, glyphs without an outline like the space don't count. Renders into the atlas textures, so call it on the thread with the GL context.
+	size_t	prepareGlyphs( const std::vector<SdfText::Font::Glyph> &glyphs );
 	//! Draws the glyphs in \a glyphMeasures clipped by \a clip, with \a offset added to each of the glyph offsets with DrawOptions \a options. \a glyphMeasures is a vector of pairs of glyph indices and offsets for the glyph baselines.
 	void	drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const Rectf &clip, vec2 offset, const DrawOptions &options = DrawOptions(), const std::vector<ColorA8u> &colors = std::vector<ColorA8u>() );
 
-	//! Returns the size in pixels necessary to render the string \a str with DrawOptions \a options.
+	//! Returns the size in pixels necessary to render the string \a str with DrawOptions \a options. Measuring and the glyph placements below are safe to call from any thread, while drawing and prepareGlyphs() run on the GL thread.
 	vec2	measureString( const std::string &str, const DrawOptions &options = DrawOptions() ) const;
     
 	//! Returns a vector of glyph/placement pairs representing \a str, suitable for use with drawGlyphs. Useful for caching placement and optimizing batching.
@@ -250,22 +422,150 @@ public:
 	//! \c "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890().?!,:;'\"&*=+-/\\@#_[]<>%^llflfiphrids"
 	static std::string		defaultChars();
 
+	//! Returns the number of atlas textures. Returns \c 0 if the atlas pages are stored in a texture array.
 	uint32_t				getNumTextures() const;
 	const gl::TextureRef&	getTexture( uint32_t n ) const;
+#if ! defined( CINDER_GL_ES_2 )
+	//! Returns the texture array holding the atlas pages if Format::textureArray() was set, otherwise \c nullptr. Dynamic atlases replace it by a larger or smaller one as pages are added or compacted away.
+	const gl::Texture3dRef&	getTextureArray() const;
+#endif
 
-private:
-	SdfText( const SdfText::Font &font, const Format &format, const std::string &utf8Chars );
-	friend class SdfTextManager;
+	// ---------------------------------------------------------------------------------------------
+
+	//! \struct AtlasCacheStats
+	//! Counters and memory use of the atlas cache shared by all SdfText instances
+	struct AtlasCacheStats {
+		size_t	hits = 0;
+		//! Hits served by a cached atlas containing a superset of the requested glyphs
+		size_t	subsetHits = 0;
+		size_t	misses = 0;
+		//! Misses served by an atlas loaded from the disk cache directory
+		size_t	diskHits = 0;
+		//! Misses served by downsampling the atlas at Format::pyramidSdfScale()
+		size_t	derived = 0;
+		size_t	evictions = 0;
+		size_t	numAtlases = 0;
+		size_t	numUnusedAtlases = 0;
+		size_t	gpuBytes = 0;
+		//! Size of the compressed CPU copies of the pages, see Format::keepCompressedPages()
+		size_t	cpuBytes = 0;
+		//! Approximate size of the CPU side glyph and character maps
+		size_t	mapBytes = 0;
+		size_t	numGlyphs = 0;
+		size_t	numPages = 0;
+		//! Texels of all pages not covered by glyph cells
+		uint64_t	wastedTexels = 0;
+		//! Fraction of the texels of all pages covered by glyph cells
+		float	fillRatio = 0.0f;
+		//! Seconds spent building the cached atlases
+		double	buildTime = 0.0;
+		size_t	budget = 0;
+	};
+
+	//! \struct GlyphResidencyStats
+	//! Glyph lookup and eviction counters of an atlas
+	struct GlyphResidencyStats {
+		//! Glyph lookups served by a glyph already in the atlas
+		size_t	hits = 0;
+		//! Glyphs rendered into a dynamic atlas on demand
+		size_t	misses = 0;
+		//! Glyphs evicted from a dynamic atlas to make room for others
+		size_t	evictions = 0;
+		//! Glyphs that couldn't be drawn because the atlas lacks them or every cell was in use by the same draw
+		size_t	failures = 0;
+		//! Glyphs that share the cell of another glyph with an identical outline, possibly of another face
+		size_t	sharedGlyphs = 0;
+		size_t	residentGlyphs = 0;
+		//! Number of glyphs the atlas can hold
+		size_t	capacity = 0;
+		//! Cells moved to another page by compactAtlas()
+		size_t	compactionMoves = 0;
+	};
+
+	//! Returns the glyph residency counters of the atlas used by this SdfText, which may be shared with other SdfText instances
+	GlyphResidencyStats		getGlyphResidencyStats() const;
+	//! Compacts a dynamic atlas by moving up to \a maxCellMoves glyph cells off its last page into free cells of the other pages, releasing the page once it's empty. Cells are copied on the GPU, nothing is regenerated. Glyphs not drawn during the last \a maxIdleDraws draws are evicted first, unless it's \c 0. Call once per frame to spread the work. Returns \c true while there's a page left to free.
+	bool					compactAtlas( size_t maxCellMoves = 64, uint32_t maxIdleDraws = 0 );
+
+	//! \struct AtlasLayout
+	//! Page size, page count and occupancy of an atlas
+	struct AtlasLayout {
+		//! Size of the atlas pages, picked by the atlas if Format::autoTextureSize() is set
+		ivec2		textureSize = ivec2( 0 );
+		uint32_t	numPages = 0;
+		//! Glyph cells on the pages, glyphs with identical outlines share one
+		size_t		numCells = 0;
+		//! Fraction of the texels of all pages covered by glyph cells
+		float		fillRatio = 0.0f;
+	};
+
+	//! Returns the page layout of the atlas used by this SdfText
+	AtlasLayout				getAtlasLayout() const;
+
+	//! \struct AtlasStats
+	//! Layout, memory use and build time of an atlas
+	struct AtlasStats {
+		AtlasLayout	layout;
+		//! Size of the uniform glyph cells, zero if every glyph has its own with Format::adaptiveSdfScale()
+		ivec2		cellSize = ivec2( 0 );
+		//! Texels of the pages not covered by glyph cells
+		uint64_t	wastedTexels = 0;
+		size_t		numGlyphs = 0;
+		size_t		gpuBytes = 0;
+		//! Size of the compressed CPU copies of the pages, see Format::keepCompressedPages()
+		size_t		cpuBytes = 0;
+		//! Approximate size of the CPU side glyph and character maps
+		size_t		mapBytes = 0;
+		//! Seconds spent generating, deriving or loading the pages, including glyphs a dynamic atlas rendered on demand
+		double		buildTime = 0.0;
+	};
 
+	//! Returns the memory use and occupancy of the atlas used by this SdfText, which may be shared with other SdfText instances
+	AtlasStats				getAtlasStats() const;
+	//! Returns the memory use and occupancy of every atlas in the atlas cache
+	static std::vector<AtlasStats>	getCachedAtlasStats();
+
+	//! Returns hit/miss counters and the current size of the texture atlas cache shared by all SdfText instances
+	static AtlasCacheStats	getAtlasCacheStats();
+	//! Sets the approximate texture memory budget in bytes for the atlas cache. Atlases no longer used by any SdfText are evicted in least recently used order once the budget is exceeded. Default \c 0 (unlimited)
+	static void				setAtlasCacheBudget( size_t bytes );
+	//! Returns the texture memory budget of the atlas cache. Default \c 0 (unlimited)
+	static size_t			getAtlasCacheBudget();
+	//! Releases every cached atlas that is no longer used by any SdfText
+	static void				purgeUnusedAtlases();
+	//! Sets a directory where generated atlases are stored compressed and loaded from instead of being regenerated. Default empty (disabled)
+	static void				setAtlasDiskCacheDirectory( const fs::path &directory );
+	//! Returns the atlas disk cache directory. Default empty (disabled)
+	static fs::path			getAtlasDiskCacheDirectory();
+	//! Stops the background tasks and releases the atlas cache, the faces and FreeType. Call it with the GL context current once every SdfText and Font 
+	//! is released, such as from App::cleanup(). Otherwise it runs at exit, where the atlas textures are left to the OS if no GL context is current. 
+	//! Using SdfText afterwards starts over.
+	static void				shutdown();
+
+private:
 	class TextureAtlas;
 	using TextureAtlasRef = std::shared_ptr<TextureAtlas>;
 
+	//! Calls \a onAtlasPublished if it builds a static atlas, once the atlas is laid out and before its pages are generated
+	SdfText( const SdfText::Font &font, const Format &format, const std::string &utf8Chars, const std::vector<SdfText::Font::Glyph> &glyphs, const std::function<void()> &onAtlasPublished = std::function<void()>() );
+	SdfText( const SdfText::Font &font, const Format &format, const TextureAtlasRef &textureAtlas, uint32_t faceSlot );
+	friend class SdfTextManager;
+
 	SdfText::Font					mFont;
 	Format							mFormat;
 	TextureAtlasRef					mTextureAtlases;
+	//! Slot of the font's face in a texture atlas that may be shared with other faces
+	uint32_t						mFaceSlot = 0;
 
-	SdfText::Font::GlyphMetricsMap	mCachedGlyphMetrics;
+	//! Dynamic atlases fill in the metrics of glyphs as they are first measured. Guarded by the font's face lock.
+	mutable SdfText::Font::GlyphMetricsMap	mCachedGlyphMetrics;
+	//! Lays out \a str in a box of \a boxSize, caching the metrics of its glyphs first
+	SdfText::Font::GlyphMeasures	measureGlyphs( const std::string &str, const ivec2 &boxSize, const DrawOptions &options ) const;
 	void							cacheGlyphMetrics();
+	void							cacheGlyphMetrics( const std::string &utf8Chars ) const;
+	void							cacheGlyphMetrics( const std::vector<SdfText::Font::Glyph> &glyphs ) const;
+
+	void							drawGlyphQuadBatches( const std::vector<detail::GlyphQuadBatch> &batches, const DrawOptions &options );
 };
 
 }} // namespace cinder::gl
\ No newline at end of file
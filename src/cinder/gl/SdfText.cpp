@@ -40,38 +40,74 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "cinder/ImageIo.h"
 #include "cinder/Log.h"
 #include "cinder/Text.h"
+#include "cinder/Timer.h"
 #include "cinder/Unicode.h"
 #include "cinder/Utilities.h"
 
-#include "cinder/app/App.h"
+#include "SdfTextInternal.h"
+
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_SIZES_H
 #include <ftsnames.h>
 #include <ttnameid.h>
 
 #include "msdfgen/msdfgen.h"
 #include "msdfgen/util.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
 
 #if defined( CINDER_MSW )
 	#include <Windows.h>
+#elif defined( CINDER_COCOA ) || defined( CINDER_LINUX ) || defined( CINDER_ANDROID )
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+	#include <emmintrin.h>
+	#define SDF_TEXT_SSE2
 #endif
 
 static const float MAX_SIZE = 1000000.0f;
 
 namespace cinder { namespace gl {
 
+using namespace detail;
+
+// The shaders are compiled with a "#version 150" header, optionally followed by "#define SDF_TEXTURE_ARRAY" 
+// for atlases whose pages are stored in a 2D texture array with the page layer in the third texcoord.
 static std::string kSdfVertShader = 
-	"#version 150\n"
 	"uniform mat4 ciModelViewProjection;\n"
 	"in vec4 ciPosition;\n"
+	"#if defined( SDF_TEXTURE_ARRAY )\n"
+	"in vec3 ciTexCoord0;\n"
+	"out vec3 TexCoord;\n"
+	"#else\n"
 	"in vec2 ciTexCoord0;\n"
 	"out vec2 TexCoord;\n"
+	"#endif\n"
 	"void main()\n"
 	"{\n"
 	"	gl_Position = ciModelViewProjection * ciPosition;\n"
@@ -79,13 +115,23 @@ static std::string kSdfVertShader =
 	"}\n";
 
 
-static std::string kSdfFragMinimalShader = 
-	"#version 150\n"
+static std::string kSdfFragSampler = 
+	"#if defined( SDF_TEXTURE_ARRAY )\n"
+	"uniform sampler2DArray uTex0;\n"
+	"in vec3           TexCoord;\n"
+	"#define SDF_UV         TexCoord.xy\n"
+	"#define SDF_TEX_SIZE   textureSize( uTex0, 0 ).xy\n"
+	"#else\n"
 	"uniform sampler2D uTex0;\n"
+	"in vec2           TexCoord;\n"
+	"#define SDF_UV         TexCoord\n"
+	"#define SDF_TEX_SIZE   textureSize( uTex0, 0 )\n"
+	"#endif\n";
+
+static std::string kSdfFragMinimalShader = 
 	"uniform vec4      uFgColor;\n"
 	"uniform float     uPremultiply;\n"
 	"uniform float     uGamma;\n"
-	"in vec2           TexCoord;\n"
 	"out vec4          Color;\n"
 	"\n"
 	"float median( float r, float g, float b ) {\n"
@@ -94,9 +140,9 @@ static std::string kSdfFragMinimalShader =
 	"\n"
 	"void main() {\n"
 	"    vec3 sample = texture( uTex0, TexCoord ).rgb;\n"
-	"    ivec2 sz = textureSize( uTex0, 0 );\n"
-	"    float dx = dFdx( TexCoord.x ) * sz.x;\n"
-	"    float dy = dFdy( TexCoord.y ) * sz.y;\n"
+	"    ivec2 sz = SDF_TEX_SIZE;\n"
+	"    float dx = dFdx( SDF_UV.x ) * sz.x;\n"
+	"    float dy = dFdy( SDF_UV.y ) * sz.y;\n"
 	"    float toPixels = 8.0 * inversesqrt( dx * dx + dy * dy );\n"
 	"    float sigDist = median( sample.r, sample.g, sample.b ) - 0.5;\n"
 	"    float opacity = clamp( sigDist * toPixels + 0.5, 0.0, 1.0 );\n"
@@ -108,12 +154,9 @@ static std::string kSdfFragMinimalShader =
 	"}\n";
 
 static std::string kSdfFragShader = 
-	"#version 150\n"
-	"uniform sampler2D uTex0;\n"
 	"uniform vec4      uFgColor;\n"
 	"uniform float     uPremultiply;\n"
 	"uniform float     uGamma;\n"
-	"in vec2           TexCoord;\n"
 	"out vec4          Color;\n"
 	"\n"
 	"float median( float r, float g, float b ) {\n"
@@ -128,7 +171,7 @@ static std::string kSdfFragShader =
 	"\n"
 	"void main(void) {\n"
 	"    // Convert normalized texcoords to absolute texcoords.\n"
-	"    vec2 uv = TexCoord * textureSize( uTex0, 0 );\n"
+	"    vec2 uv = SDF_UV * SDF_TEX_SIZE;\n"
 	"    // Calculate derivates\n"
 	"    vec2 Jdx = dFdx( uv );\n"
 	"    vec2 Jdy = dFdy( uv );\n"
@@ -153,6 +196,191 @@ static std::string kSdfFragShader =
 
 static gl::GlslProgRef sDefaultMinimalShader;
 static gl::GlslProgRef sDefaultShader;
+static gl::GlslProgRef sDefaultMinimalArrayShader;
+static gl::GlslProgRef sDefaultArrayShader;
+
+// =================================================================================================
+// SDF bitmap conversion
+// =================================================================================================
+//! Quantizes one channel the way Color to Color8u does: clamp to [0, 1], scale by 255 and truncate.
+//! NaNs end up as 0, same as the SSE2 path.
+static inline uint8_t quantizeSdfChannel( float v )
+{
+	v = ( v > 0.0f ) ? ( ( v < 1.0f ) ? v : 1.0f ) : 0.0f;
+	return static_cast<uint8_t>( v * 255.0f );
+}
+
+//! Converts \a count floats to 8-bit channels. FloatRGB is three packed floats, so a row of a bitmap 
+//! is converted as 3 * width consecutive channels.
+static void quantizeSdfChannels( const float *src, uint8_t *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( SDF_TEXT_SSE2 )
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	for( ; ( i + 16 ) <= count; i += 16 ) {
+		// max( v, 0 ) returns the second operand for NaN
+		__m128 v0 = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i +  0 ), zero ), one );
+		__m128 v1 = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i +  4 ), zero ), one );
+		__m128 v2 = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i +  8 ), zero ), one );
+		__m128 v3 = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i + 12 ), zero ), one );
+		// Truncating conversion, the values are within [0, 255] so the saturating packs are exact
+		__m128i i0 = _mm_cvttps_epi32( _mm_mul_ps( v0, scale ) );
+		__m128i i1 = _mm_cvttps_epi32( _mm_mul_ps( v1, scale ) );
+		__m128i i2 = _mm_cvttps_epi32( _mm_mul_ps( v2, scale ) );
+		__m128i i3 = _mm_cvttps_epi32( _mm_mul_ps( v3, scale ) );
+		__m128i packed = _mm_packus_epi16( _mm_packs_epi32( i0, i1 ), _mm_packs_epi32( i2, i3 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( dst + i ), packed );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		dst[i] = quantizeSdfChannel( src[i] );
+	}
+}
+
+//! Converts \a bitmap to RGB8 rows starting at \a dst that are \a dstRowBytes apart
+static void copySdfBitmap( const msdfgen::Bitmap<msdfgen::FloatRGB> &bitmap, uint8_t *dst, size_t dstRowBytes )
+{
+	const int width = bitmap.width();
+	const int height = bitmap.height();
+	if( ( width <= 0 ) || ( height <= 0 ) ) {
+		return;
+	}
+
+	static_assert( sizeof( msdfgen::FloatRGB ) == ( 3 * sizeof( float ) ), "FloatRGB must be three packed floats" );
+	const size_t rowChannels = 3 * static_cast<size_t>( width );
+	for( int n = 0; n < height; ++n ) {
+		const float *src = &( bitmap( 0, n ).r );
+		quantizeSdfChannels( src, dst, rowChannels );
+		dst += dstRowBytes;
+	}
+}
+
+//! Resamples the RGB8 cell \a srcArea of \a src into the \a dstSize cell at \a dstPos of \a dst, where \a ratio 
+//! is the source SDF scale over the destination one. Distances are stored relative to an SDF range in shape 
+//! units, so the values don't depend on the scale and a cell of a lower scale is a bilinear resampling of 
+//! the same field. Rows are mapped from the bottom of the cell where the glyph transform is anchored.
+static void resampleSdfCell( const Surface8u &src, const Area &srcArea, Surface8u *dst, const ivec2 &dstPos, const ivec2 &dstSize, const vec2 &ratio )
+{
+	const int srcWidth = srcArea.getWidth();
+	const int srcHeight = srcArea.getHeight();
+	if( ( srcWidth <= 0 ) || ( srcHeight <= 0 ) ) {
+		return;
+	}
+
+	const uint8_t *srcData = src.getData();
+	const size_t srcRowBytes = src.getRowBytes();
+	const size_t srcPixelInc = src.getPixelInc();
+	uint8_t *dstData = dst->getData();
+	const size_t dstRowBytes = dst->getRowBytes();
+	const size_t dstPixelInc = dst->getPixelInc();
+	for( int n = 0; n < dstSize.y; ++n ) {
+		float y = ( static_cast<float>( dstSize.y - 1 - n ) + 0.5f ) * ratio.y - 0.5f;
+		float srcRow = std::min( std::max( static_cast<float>( srcHeight - 1 ) - y, 0.0f ), static_cast<float>( srcHeight - 1 ) );
+		const int r0 = static_cast<int>( srcRow );
+		const int r1 = std::min( r0 + 1, srcHeight - 1 );
+		const float fy = srcRow - static_cast<float>( r0 );
+		const uint8_t *row0 = srcData + ( srcArea.y1 + r0 ) * srcRowBytes + srcArea.x1 * srcPixelInc;
+		const uint8_t *row1 = srcData + ( srcArea.y1 + r1 ) * srcRowBytes + srcArea.x1 * srcPixelInc;
+		uint8_t *dstPixel = dstData + ( dstPos.y + n ) * dstRowBytes + dstPos.x * dstPixelInc;
+		for( int m = 0; m < dstSize.x; ++m ) {
+			float srcColumn = std::min( std::max( ( static_cast<float>( m ) + 0.5f ) * ratio.x - 0.5f, 0.0f ), static_cast<float>( srcWidth - 1 ) );
+			const int c0 = static_cast<int>( srcColumn );
+			const int c1 = std::min( c0 + 1, srcWidth - 1 );
+			const float fx = srcColumn - static_cast<float>( c0 );
+			for( int c = 0; c < 3; ++c ) {
+				float top = row0[c0 * srcPixelInc + c] + fx * ( row0[c1 * srcPixelInc + c] - row0[c0 * srcPixelInc + c] );
+				float bottom = row1[c0 * srcPixelInc + c] + fx * ( row1[c1 * srcPixelInc + c] - row1[c0 * srcPixelInc + c] );
+				dstPixel[c] = static_cast<uint8_t>( top + fy * ( bottom - top ) + 0.5f );
+			}
+			dstPixel += dstPixelInc;
+		}
+	}
+}
+
+// =================================================================================================
+// Face locks
+// =================================================================================================
+//! FreeType faces can only be used by one thread at a time. Fonts of different sizes share a face and 
+//! atlases load outlines from it, so every use holds the lock of the stripe the face hashes to. The 
+//! locks are recursive so a thread holding a face can lock it again.
+static const size_t kNumFaceLockStripes = 64;
+
+using FaceLock = std::unique_lock<std::recursive_mutex>;
+
+static std::recursive_mutex& getFaceLockStripe( size_t stripe )
+{
+	static std::recursive_mutex sStripes[kNumFaceLockStripes];
+	return sStripes[stripe];
+}
+
+static size_t getFaceLockStripeIndex( FT_Face face )
+{
+	// Faces are allocated with at least 16 byte alignment
+	return static_cast<size_t>( reinterpret_cast<uintptr_t>( face ) >> 4 ) % kNumFaceLockStripes;
+}
+
+//! Locks \a face against use from other threads
+static FaceLock lockFace( FT_Face face )
+{
+	return FaceLock( getFaceLockStripe( getFaceLockStripeIndex( face ) ) );
+}
+
+// =================================================================================================
+// Unicode blocks
+// =================================================================================================
+struct UnicodeBlock {
+	uint32_t	mFirst;
+	uint32_t	mLast;
+};
+
+//! Blocks that Format::unicodeBlocks() atlases are split by, sorted. Neighboring blocks that are 
+//! small or usually used together are merged. Code points outside of these go by 256.
+static const UnicodeBlock kUnicodeBlocks[] = {
+	{ 0x0000, 0x007F },	// Basic Latin
+	{ 0x0080, 0x00FF },	// Latin-1 Supplement
+	{ 0x0100, 0x024F },	// Latin Extended-A and B
+	{ 0x0250, 0x036F },	// IPA Extensions, Spacing Modifier Letters, Combining Diacritical Marks
+	{ 0x0370, 0x03FF },	// Greek and Coptic
+	{ 0x0400, 0x052F },	// Cyrillic and Cyrillic Supplement
+	{ 0x0530, 0x058F },	// Armenian
+	{ 0x0590, 0x05FF },	// Hebrew
+	{ 0x0600, 0x06FF },	// Arabic
+	{ 0x0900, 0x097F },	// Devanagari
+	{ 0x0E00, 0x0E7F },	// Thai
+	{ 0x1E00, 0x1EFF },	// Latin Extended Additional
+	{ 0x1F00, 0x1FFF },	// Greek Extended
+	{ 0x2000, 0x206F },	// General Punctuation
+	{ 0x20A0, 0x20CF },	// Currency Symbols
+	{ 0x2100, 0x218F },	// Letterlike Symbols, Number Forms
+	{ 0x2190, 0x22FF },	// Arrows, Mathematical Operators
+	{ 0x2500, 0x25FF },	// Box Drawing, Block Elements, Geometric Shapes
+	{ 0x3000, 0x30FF },	// CJK Symbols and Punctuation, Hiragana, Katakana
+	{ 0x3400, 0x4DBF },	// CJK Unified Ideographs Extension A
+	{ 0x4E00, 0x9FFF },	// CJK Unified Ideographs
+	{ 0xAC00, 0xD7AF },	// Hangul Syllables
+	{ 0xFF00, 0xFFEF },	// Halfwidth and Fullwidth Forms
+};
+
+//! Larger blocks, like the CJK ideographs, are split into ranges of this many code points
+static const uint32_t kMaxUnicodeBlockSize = 1024;
+
+//! Returns the first code point of the block or block range that \a ch belongs to, which identifies it
+static uint32_t getUnicodeBlock( uint32_t ch )
+{
+	const UnicodeBlock *begin = std::begin( kUnicodeBlocks );
+	const UnicodeBlock *end = std::end( kUnicodeBlocks );
+	const UnicodeBlock *it = std::upper_bound( begin, end, ch, []( uint32_t value, const UnicodeBlock &block ) -> bool { return value < block.mFirst; } );
+	if( ( begin != it ) && ( ch <= ( it - 1 )->mLast ) ) {
+		const uint32_t first = ( it - 1 )->mFirst;
+		return first + ( ( ch - first ) / kMaxUnicodeBlockSize ) * kMaxUnicodeBlockSize;
+	}
+	return ch & ~static_cast<uint32_t>( 0xFF );
+}
+
+//! Interned FreeType face, see SdfTextManager::getFontFace()
+class FontFace;
 
 // =================================================================================================
 // SdfText::TextureAtlas
@@ -160,62 +388,282 @@ static gl::GlslProgRef sDefaultShader;
 class SdfText::TextureAtlas {
 public:
 
+	//! Glyphs are looked up by face slot and glyph index since an atlas may be shared by several faces
+	using GlyphKey = uint64_t;
+	using GlyphLru = std::list<GlyphKey>;
+
+	//! Outline of the glyph last loaded into a face's glyph slot. Glyphs with identical outlines, 
+	//! within or across faces, render to identical cells and share them.
+	struct OutlineKey {
+		std::vector<FT_Vector>	mPoints;
+		std::vector<char>		mTags;
+		std::vector<short>		mContours;
+
+		static OutlineKey create( FT_Face face );
+		bool operator==( const OutlineKey& rhs ) const;
+
+		struct Hasher {
+			size_t operator()( const OutlineKey& key ) const {
+				size_t result = 0;
+				for( const auto& point : key.mPoints ) {
+					boost::hash_combine( result, point.x );
+					boost::hash_combine( result, point.y );
+				}
+				boost::hash_range( result, std::begin( key.mTags ), std::end( key.mTags ) );
+				boost::hash_range( result, std::begin( key.mContours ), std::end( key.mContours ) );
+				return result;
+			}
+		};
+	};
+
 	struct GlyphInfo {
-		uint32_t	mTextureIndex;
-		Area		mTexCoords;
-		vec2		mOriginOffset;
+		uint32_t			mTextureIndex = std::numeric_limits<uint32_t>::max();
+		Area				mTexCoords;
+		vec2				mOriginOffset;
+		//! Scale the glyph was generated with, which varies per glyph with Format::adaptiveSdfScale()
+		vec2				mSdfScale = vec2( 1.0f );
+		//! Use tick of the last draw and position in the recently used list of a dynamic atlas
+		uint64_t			mLastUse = 0;
+		GlyphLru::iterator	mLruIt;
+		//! Outline of a dynamic atlas glyph, whose cell may be shared with other glyphs
+		const OutlineKey	*mOutline = nullptr;
+	};
+
+	//! Cell of a dynamic atlas along with the number of glyphs using it
+	struct OutlineCell {
+		GlyphInfo	mGlyphInfo;
+		uint32_t	mRefCount = 0;
 	};
 
+	using OutlineCellMap = std::unordered_map<OutlineKey, OutlineCell, OutlineKey::Hasher>;
+
 	// ---------------------------------------------------------------------------------------------
 
 	using CharToGlyphMap = std::unordered_map<uint32_t, SdfText::Font::Glyph>;
 	using GlyphToCharMap = std::unordered_map<SdfText::Font::Glyph, uint32_t>;
-	using GlyphInfoMap = std::unordered_map<SdfText::Font::Glyph, GlyphInfo>;
+	using GlyphInfoMap = std::unordered_map<GlyphKey, GlyphInfo>;
+
+	static GlyphKey makeGlyphKey( uint32_t faceSlot, SdfText::Font::Glyph glyph ) {
+		return ( static_cast<GlyphKey>( faceSlot ) << 32 ) | static_cast<GlyphKey>( glyph );
+	}
+
+	//! Per face lookups of a (possibly shared) atlas
+	struct FaceInfo {
+		FT_Face			mFace = nullptr;
+		CharToGlyphMap	mCharToGlyph;
+		GlyphToCharMap	mGlyphToChar;
+	};
 
 	// ---------------------------------------------------------------------------------------------
 
-	struct CacheKey {
-		std::string mFamilyName;
-		std::string mStyleName;
-		std::string mUtf8Chars;
-		ivec2		mTextureSize = ivec2( 0 );
-		ivec2		mSdfBitmapSize = ivec2( 0 );
-		bool operator==( const CacheKey& rhs ) const { 
-			return ( mFamilyName == rhs.mFamilyName ) &&
-				   ( mStyleName == rhs.mStyleName ) && 
-				   ( mUtf8Chars == rhs.mUtf8Chars ) &&
-				   ( mTextureSize == rhs.mTextureSize ) &&
-				   ( mSdfBitmapSize == rhs.mSdfBitmapSize );
-		}
-		bool operator!=( const CacheKey& rhs ) const {
-			return ( mFamilyName != rhs.mFamilyName ) ||
-				   ( mStyleName != rhs.mStyleName ) || 
-				   ( mUtf8Chars != rhs.mUtf8Chars ) ||
-				   ( mTextureSize != rhs.mTextureSize ) ||
-				   ( mSdfBitmapSize != rhs.mSdfBitmapSize );
-		}
+	using GlyphIndices = std::vector<SdfText::Font::Glyph>;
+
+	//! Identifies an atlas in the cache, see AtlasCacheKey
+	using CacheKey = AtlasCacheKey;
+
+	//! Cached atlas along with the manager tick of its last lookup. The cache holds a strong reference, 
+	//! so an atlas is considered unused once the cache is the only owner left.
+	struct CacheEntry {
+		SdfText::TextureAtlasRef	mAtlas;
+		uint64_t					mLastUsed = 0;
+		bool						isUnused() const { return 1 == mAtlas.use_count(); }
 	};
 
-	typedef std::vector<std::pair<CacheKey, SdfText::TextureAtlasRef>> AtlasCacher;
+	typedef std::unordered_map<CacheKey, CacheEntry, CacheKey::Hasher> AtlasCacher;
 
 	// ---------------------------------------------------------------------------------------------
 
 	virtual ~TextureAtlas() {}
 
-	static SdfText::TextureAtlasRef create( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars );
+	//! Creates an atlas containing \a utf8Chars and the glyph indices \a glyphs for every face in \a faces. All faces share the same texture pages.
+	static SdfText::TextureAtlasRef create( const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const GlyphIndices &glyphs );
+	//! Creates an atlas with the glyphs of \a source at the lower SDF scale of \a format by downsampling the compressed pages of \a source
+	static SdfText::TextureAtlasRef createDerived( const TextureAtlas &source, const SdfText::Format &format );
 
 	static ivec2 calculateSdfBitmapSize( const vec2 &sdfScale, const ivec2& sdfPadding, const vec2 &maxGlyphSize );
+	//! Returns the SDF scale for \a shape within the range of \a format based on its number of edges and its smallest contour
+	static float calculateAdaptiveSdfScale( const msdfgen::Shape &shape, const SdfText::Format &format );
+
+	//! Returns the canonical set of glyph indices needed to render \a utf8Chars with \a face, merged with \a glyphs. A space is 
+	//! always included, indices that \a face doesn't have are dropped.
+	static GlyphIndices getGlyphIndices( FT_Face face, const std::string &utf8Chars, const GlyphIndices &glyphs = GlyphIndices() );
+
+	//! Returns the approximate amount of texture memory used by the atlas pages (RGB8)
+	size_t		getGpuBytes() const;
+	//! Returns the texture memory the atlas adds to the cache. The pages of a Unicode block atlas belong to the atlases of its blocks, which are cached on their own. Safe to call from any thread without the lock.
+	size_t		getOwnGpuBytes() const { return mOwnGpuBytes; }
+
+	//! Returns the number of atlas pages, either textures or layers of the texture array
+	uint32_t	getNumPages() const { return mNumPages; }
+	//! Returns the number of pages the atlas may use, which is larger than getNumPages() for a dynamic atlas that hasn't filled up yet
+	uint32_t	getPageCapacity() const { return mDynamic ? mMaxPages : mNumPages.load(); }
+	bool		isDynamic() const { return mDynamic; }
+	//! Returns true if the pages are added from the atlases of Unicode blocks as they're first used, see Format::unicodeBlocks()
+	bool		isUnicodeBlocks() const { return mUnicodeBlocks; }
+	//! Returns true if glyphs may be added after creation, either by a dynamic atlas or by loading a Unicode block
+	bool		isLoadedOnDemand() const { return mDynamic || mUnicodeBlocks; }
+	//! Returns true if the atlas pages are layers of a single 2D texture array
+	bool		isTextureArray() const { return mIsTextureArray; }
+	//! Returns the normalized texture coordinates of \a area on any page, see detail::getPageTexCoords()
+	Rectf		getTexCoords( const Area &area ) const { return getPageTexCoords( area, mTextureSize ); }
+
+	//! Keeps \a face alive for as long as the atlas, which may still load outlines from it
+	void		retainFace( const std::shared_ptr<FontFace> &face ) { mFaceRefs.push_back( face ); }
+
+	//! Returns the compressed CPU copies of the pages, empty unless Format::keepCompressedPages() was set
+	const std::vector<AtlasPageCodec::Page>&	getCompressedPages() const { return mCompressedPages; }
+	//! Returns the size of the compressed CPU copies of the pages in bytes
+	size_t		getCpuBytes() const;
+	void		releaseCompressedPages() { std::lock_guard<std::recursive_mutex> lock( mMutex ); mCompressedPages.clear(); }
+
+	//! Renders the pages laid out by the constructor in order, adding each as soon as it's done. The atlas may already be 
+	//! in use meanwhile, its glyphs become available page by page, see Format::glyphPriorities().
+	void		generatePages();
+	//! Marks the atlas complete once its pages are generated and stored, or failed to
+	void		completePages();
+	//! Returns false while the pages of a static atlas are still being generated
+	bool		isComplete() const { std::lock_guard<std::recursive_mutex> lock( mMutex ); return mComplete; }
+	//! Blocks until completePages() is called
+	void		waitUntilComplete() const;
+
+	//! Starts a draw. Glyphs acquired during the same draw are never evicted in favor of each other.
+	void		beginUse() { std::lock_guard<std::recursive_mutex> lock( mMutex ); ++mUseTick; }
+	//! Copies the info of the glyph \a glyphKey to \a result if it's in the atlas. Unlike acquireGlyph() it doesn't add the glyph, so it's safe to call from any thread. 
+	//! Glyphs whose page isn't generated yet are skipped unless \a generatedOnly is false, their place on the page is known from the start.
+	bool		findGlyphInfo( GlyphKey glyphKey, GlyphInfo *result, bool generatedOnly = true ) const;
+	//! Returns the glyph \a glyph of the face in \a faceSlot or \c nullptr if it's not available. A dynamic atlas 
+	//! renders missing glyphs on demand, evicting the least recently drawn glyphs once all pages are full. A Unicode 
+	//! block atlas adds the pages of the block of a missing glyph, which may add pages during a draw. Glyphs of a 
+	//! static atlas whose page isn't uploaded yet are \c nullptr until finishPages() uploads it.
+	const GlyphInfo*	acquireGlyph( uint32_t faceSlot, SdfText::Font::Glyph glyph );
+	SdfText::GlyphResidencyStats	getGlyphResidencyStats() const;
+	//! Evicts the glyphs of a dynamic atlas that weren't drawn during the last \a maxIdleUses uses, unless it's 0, then moves 
+	//! up to \a maxCellMoves cells off the last page into free cells of the other pages. The last page is released once 
+	//! it's empty. Cells are copied on the GPU, nothing is regenerated. Returns true if another call can free a page.
+	bool		compact( size_t maxCellMoves, uint64_t maxIdleUses );
+	SdfText::AtlasLayout			getAtlasLayout() const;
+	SdfText::AtlasStats				getAtlasStats() const;
+	//! Returns the approximate size of the glyph, character and outline maps
+	size_t		getMapBytes() const;
+	//! Returns the number of texels of all pages and of the distinct glyph cells on them, optionally along with the number of cells
+	uint64_t	getNumTexels() const;
+	uint64_t	getNumCellTexels( size_t *numCells ) const;
+
+	//! Writes the atlas along with \a key to \a path. Requires the compressed pages. Returns false if the file can't be written.
+	bool		save( const fs::path &path, const CacheKey &key ) const;
+	//! Loads an atlas for \a faces written by save(). Returns \c nullptr if the file is missing, malformed or was written for a different key.
+	static SdfText::TextureAtlasRef load( const fs::path &path, const CacheKey &key, const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars );
 
 private:
-	TextureAtlas( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars );
+	TextureAtlas( const SdfText::Format &format );
+	TextureAtlas( const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const GlyphIndices &extraGlyphs );
+	TextureAtlas( const TextureAtlas &source, const SdfText::Format &format );
 	friend class SdfText;
 
-	FT_Face						mFace = nullptr;
+	//! Returns the page size for \a glyphs up to the maximum of \a format and GL_MAX_TEXTURE_SIZE, see detail::chooseTextureSize()
+	static ivec2 chooseTextureSize( const std::vector<RenderGlyph> &glyphs, bool packed, const ivec2 &tileSpacing, const SdfText::Format &format );
+	//! Returns GL_MAX_TEXTURE_SIZE if a GL context is current or has been seen before, otherwise \c 0
+	static GLint getMaxGlTextureSize();
+
+	//! Adds the character maps of \a face for \a utf8Chars as the next face slot
+	void		addFace( FT_Face face, const std::string &utf8Chars );
+	//! Uploads \a surface as the next page. Texture array pages, and any page added on a thread without a GL context, are staged until finishPages() is called.
+	void		addPage( const Surface8u &surface );
+	//! Uploads the staged pages if a GL context is current on this thread, otherwise they stay staged until it's called on the GL thread
+	void		finishPages();
+	//! Returns true if some pages are still staged
+	bool		hasPendingPages() const { std::lock_guard<std::recursive_mutex> lock( mMutex ); return ! mPendingPages.empty(); }
+
+	//! Cell of a dynamic atlas page
+	struct Cell {
+		uint32_t	mPage = 0;
+		ivec2		mPosition = ivec2( 0 );
+	};
+
+	//! Sets up the cell grid of a dynamic atlas, cells are sized to fit any glyph of \a faces
+	void		initDynamic( const std::vector<FT_Face> &faces, const SdfText::Format &format );
+	//! Returns a free cell of a dynamic atlas, adding a page or evicting the least recently drawn glyphs if needed
+	bool		allocateCell( Cell *cell );
+	//! Evicts the least recently drawn glyph unless it's part of the current draw, in which case every glyph is. Its cell is freed once no glyph shares it anymore.
+	bool		evictLeastRecentlyUsedGlyph();
+	//! Renders the outline \a shape into \a cell and uploads it
+	void		renderGlyph( msdfgen::Shape &shape, const Cell &cell, GlyphInfo *glyphInfo );
+	//! Copies the texels of cell \a src to cell \a dst using the framebuffer \a fbo to read from
+	void		copyCell( const Cell &src, const Cell &dst, GLuint fbo );
+#if ! defined( CINDER_GL_ES_2 )
+	//! Replaces the texture array of a dynamic atlas by one of \a numLayers layers, copying over the layers of the pages in use
+	void		resizeTextureArray( uint32_t numLayers );
+#endif
+	//! Returns true if the glyphs of a dynamic atlas fit into one page less
+	bool		canReleasePage() const;
+
+	//! Sets up an atlas whose pages are added by Unicode block, the blocks use \a format without unicodeBlocks()
+	void		initUnicodeBlocks( const SdfText::Format &format );
+	//! Assigns the glyphs of every face to the block of the first character mapped to them
+	void		mapUnicodeBlocks();
+	//! Gets the atlas of the block of \a glyph from the manager and adds its pages. Returns false if the glyph has no block or it was loaded before.
+	bool		loadUnicodeBlock( uint32_t faceSlot, SdfText::Font::Glyph glyph );
+	//! Adds the pages and glyphs of \a block after the current pages
+	void		addUnicodeBlock( const TextureAtlas &block );
+
+	//! Guards the glyphs and pages of atlases loaded on demand, which the GL thread adds to while other threads measure 
+	//! and gather stats. Taken before face locks, and never by the manager while it holds its own lock.
+	mutable std::recursive_mutex	mMutex;
+	std::atomic<size_t>			mOwnGpuBytes{ 0 };
+	//! Updates getOwnGpuBytes() after the pages changed
+	void						updateOwnGpuBytes() { mOwnGpuBytes = mUnicodeBlocks ? 0 : getGpuBytes(); }
+
+	std::vector<FaceInfo>		mFaces;
 	std::vector<gl::TextureRef>	mTextures;
-	CharToGlyphMap				mCharToGlyph;
-	GlyphToCharMap				mGlyphToChar;
+#if ! defined( CINDER_GL_ES_2 )
+	gl::Texture3dRef			mTextureArray;
+#endif
+	std::vector<Surface8u>		mPendingPages;
+	bool						mIsTextureArray = false;
+	bool						mAdaptiveSdfScale = false;
+	//! Seconds spent generating, deriving or loading the pages
+	double						mBuildTime = 0.0;
+	//! Pages added so far, read without the lock to size the batches of a draw
+	std::atomic<uint32_t>		mNumPages{ 0 };
+	//! Glyphs of the pages generatePages() has yet to render, and the number of pages laid out
+	std::vector<std::vector<RenderGlyph>>	mRenderPages;
+	uint32_t					mNumPlannedPages = 0;
+	bool						mComplete = true;
+	mutable std::condition_variable_any	mCompleteCondition;
+	bool						mKeepCompressedPages = false;
+	std::vector<AtlasPageCodec::Page>	mCompressedPages;
+
+	bool						mDynamic = false;
+	uint32_t					mMaxPages = 0;
+	ivec2						mTileSpacing = ivec2( 0 );
+	double						mSdfRange = 0.0;
+	double						mSdfAngle = 0.0;
+	std::vector<Cell>			mFreeCells;
+	std::unordered_set<GlyphKey>	mUnavailableGlyphs;
+	GlyphLru					mGlyphLru;
+	OutlineCellMap				mOutlineCells;
+	size_t						mNumSharedGlyphs = 0;
+	uint64_t					mUseTick = 0;
+	size_t						mNumCellsPerPage = 0;
+	size_t						mNumHits = 0;
+	size_t						mNumMisses = 0;
+	size_t						mNumEvictions = 0;
+	size_t						mNumFailures = 0;
+	size_t						mNumCompactionMoves = 0;
+	ivec2						mTextureSize = ivec2( 0 );
 	GlyphInfoMap				mGlyphInfo;
 
+	std::vector<std::shared_ptr<FontFace>>	mFaceRefs;
+
+	bool						mUnicodeBlocks = false;
+	SdfText::Format				mBlockFormat;
+	//! Per face, block of each glyph mapped by a character
+	std::vector<std::unordered_map<SdfText::Font::Glyph, uint32_t>>	mGlyphBlocks;
+	std::map<uint32_t, std::u32string>	mBlockChars;
+	std::unordered_set<uint32_t>		mLoadedBlocks;
+	//! Atlases of the loaded blocks, which own the pages as well
+	std::vector<SdfText::TextureAtlasRef>	mBlockAtlases;
+
 	//! Base scale that SDF generator uses is size 32 at 72 DPI. A scale of 1.5, 2.0, and 3.0 translates to size 48, 64 and 96 and 72 DPI.
 	vec2						mSdfScale = vec2( 1.0f );
 	vec2						mSdfPadding = vec2( 2.0f );
@@ -226,555 +674,2599 @@ private:
 
 };
 
-SdfText::TextureAtlas::TextureAtlas( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars )
-	: mFace( face ), mSdfScale( format.getSdfScale() ), mSdfPadding( format.getSdfPadding() )
+SdfText::TextureAtlas::TextureAtlas( const SdfText::Format &format )
+	: mAdaptiveSdfScale( format.getAdaptiveSdfScale() && ( ! format.getDynamic() ) ), mKeepCompressedPages( format.getKeepCompressedPages() ), mTextureSize( format.getTextureSize() ), mSdfScale( format.getSdfScale() ), mSdfPadding( format.getSdfPadding() )
+{
+#if ! defined( CINDER_GL_ES_2 )
+	mIsTextureArray = format.getTextureArray();
+#endif
+}
+
+SdfText::TextureAtlas::TextureAtlas( const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const GlyphIndices &extraGlyphs )
+	: TextureAtlas( format )
+{
+	const ivec2& tileSpacing = format.getSdfTileSpacing();
+
+	// Dynamic atlases start out empty
+	if( format.getDynamic() ) {
+		for( const auto& face : faces ) {
+			addFace( face, utf8Chars );
+		}
+		initDynamic( faces, format );
+		return;
+	}
+
+	// So do Unicode block atlases
+	if( format.getUnicodeBlocks() ) {
+		for( const auto& face : faces ) {
+			addFace( face, utf8Chars );
+		}
+		initUnicodeBlocks( format );
+		return;
+	}
+
+	Timer timer( true );
+	const bool adaptiveSdfScale = format.getAdaptiveSdfScale();
+
+	// Glyphs of all faces, grouped by face
+	std::vector<RenderGlyph> glyphs;
+	// Glyphs whose outline was seen before only get a cell once, the others copy its info after rendering
+	std::unordered_map<OutlineKey, GlyphKey, OutlineKey::Hasher> uniqueOutlines;
+	std::vector<std::pair<GlyphKey, GlyphKey>> sharedGlyphs;
+
+	// Build the maps and information pieces that will be needed later
+	for( uint32_t faceSlot = 0; faceSlot < static_cast<uint32_t>( faces.size() ); ++faceSlot ) {
+		FT_Face face = faces[faceSlot];
+		addFace( face, utf8Chars );
+
+		const GlyphIndices glyphIndices = SdfText::TextureAtlas::getGlyphIndices( face, utf8Chars, extraGlyphs );
+		for( const auto& glyphIndex : glyphIndices ) {
+			RenderGlyph renderGlyph;
+			renderGlyph.faceSlot = faceSlot;
+			renderGlyph.glyphIndex = glyphIndex;
+			renderGlyph.sdfScale = mSdfScale;
+
+			// Glyph bounds, 
+			msdfgen::Shape shape;
+			OutlineKey outline;
+			bool loaded = false;
+			{
+				FaceLock faceLock = lockFace( face );
+				loaded = msdfgen::loadGlyph( shape, face, glyphIndex );
+				if( loaded ) {
+					outline = OutlineKey::create( face );
+				}
+			}
+			if( loaded ) {
+				const GlyphKey glyphKey = makeGlyphKey( faceSlot, glyphIndex );
+				auto outlineIt = uniqueOutlines.insert( std::make_pair( std::move( outline ), glyphKey ) ).first;
+				if( glyphKey != outlineIt->second ) {
+					sharedGlyphs.push_back( std::make_pair( glyphKey, outlineIt->second ) );
+					continue;
+				}
+
+				double l, b, r, t;
+				l = b = r = t = 0.0;
+				shape.bounds( l, b, r, t );
+				// Glyph bounds
+				Rectf bounds = Rectf( 
+					static_cast<float>( l ), 
+					static_cast<float>( b ), 
+					static_cast<float>( r ), 
+					static_cast<float>( t ) );
+				mGlyphInfo[glyphKey].mOriginOffset = vec2( l, b );
+				// Max glyph size
+				mMaxGlyphSize.x = std::max( mMaxGlyphSize.x, bounds.getWidth() );
+				mMaxGlyphSize.y = std::max( mMaxGlyphSize.y, bounds.getHeight() );
+				// Max ascent, descent
+				mMaxAscent = std::max( mMaxAscent, static_cast<float>( t ) );
+				mMaxDescent = std::max( mMaxAscent, static_cast<float>( std::fabs( b ) ) );
+				// Per glyph cell that fits just this glyph
+				if( adaptiveSdfScale ) {
+					renderGlyph.sdfScale = vec2( calculateAdaptiveSdfScale( shape, format ) );
+					renderGlyph.bitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( renderGlyph.sdfScale, mSdfPadding, bounds.getSize() );
+				}
+			}
+
+			glyphs.push_back( renderGlyph );
+		}
+	}
+
+	// Glyphs of characters with a priority go on the first pages, which are generated and published first
+	const auto& charPriorities = format.getGlyphPriorities();
+	if( ! charPriorities.empty() ) {
+		std::unordered_map<GlyphKey, float> glyphPriorities;
+		for( uint32_t faceSlot = 0; faceSlot < static_cast<uint32_t>( faces.size() ); ++faceSlot ) {
+			FaceLock faceLock = lockFace( faces[faceSlot] );
+			for( const auto& it : charPriorities ) {
+				FT_UInt glyphIndex = FT_Get_Char_Index( faces[faceSlot], static_cast<FT_ULong>( it.first ) );
+				if( 0 == glyphIndex ) {
+					continue;
+				}
+				auto inserted = glyphPriorities.insert( std::make_pair( makeGlyphKey( faceSlot, glyphIndex ), it.second ) );
+				if( ! inserted.second ) {
+					inserted.first->second = std::max( inserted.first->second, it.second );
+				}
+			}
+		}
+		// Glyphs sharing an outline are drawn from the cell of the first one
+		for( const auto& sharedGlyph : sharedGlyphs ) {
+			auto sharedIt = glyphPriorities.find( sharedGlyph.first );
+			if( glyphPriorities.end() != sharedIt ) {
+				auto inserted = glyphPriorities.insert( std::make_pair( sharedGlyph.second, sharedIt->second ) );
+				if( ! inserted.second ) {
+					inserted.first->second = std::max( inserted.first->second, sharedIt->second );
+				}
+			}
+		}
+		for( auto& renderGlyph : glyphs ) {
+			auto it = glyphPriorities.find( makeGlyphKey( renderGlyph.faceSlot, renderGlyph.glyphIndex ) );
+			if( glyphPriorities.end() != it ) {
+				renderGlyph.priority = it->second;
+			}
+		}
+	}
+
+	// Determine render bitmap size
+	mSdfBitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( mSdfScale, mSdfPadding, mMaxGlyphSize );
+	if( ! adaptiveSdfScale ) {
+		for( auto& renderGlyph : glyphs ) {
+			renderGlyph.bitmapSize = mSdfBitmapSize;
+		}
+	}
+
+	if( format.getAutoTextureSize() ) {
+		mTextureSize = SdfText::TextureAtlas::chooseTextureSize( glyphs, adaptiveSdfScale, tileSpacing, format );
+	}
+
+	// Glyphs with an adaptive scale are packed, the others go into a grid of the uniform cell size. 
+	// Their place is final, so the glyphs are known before any page is generated.
+	mRenderPages = planPages( std::move( glyphs ), adaptiveSdfScale, mSdfBitmapSize, mTextureSize, tileSpacing );
+	mNumPlannedPages = static_cast<uint32_t>( mRenderPages.size() );
+	for( uint32_t page = 0; page < mNumPlannedPages; ++page ) {
+		for( const auto& renderGlyph : mRenderPages[page] ) {
+			// Glyphs without an outline have no info and leave their cell empty
+			auto glyphInfoIt = mGlyphInfo.find( makeGlyphKey( renderGlyph.faceSlot, renderGlyph.glyphIndex ) );
+			if( mGlyphInfo.end() != glyphInfoIt ) {
+				glyphInfoIt->second.mTextureIndex = page;
+				glyphInfoIt->second.mTexCoords = Area( 0, 0, renderGlyph.bitmapSize.x, renderGlyph.bitmapSize.y ) + renderGlyph.position;
+				glyphInfoIt->second.mSdfScale = renderGlyph.sdfScale;
+			}
+		}
+	}
+	// Glyphs too large for a page aren't placed
+	for( auto glyphInfoIt = mGlyphInfo.begin(); glyphInfoIt != mGlyphInfo.end(); ) {
+		if( std::numeric_limits<uint32_t>::max() == glyphInfoIt->second.mTextureIndex ) {
+			glyphInfoIt = mGlyphInfo.erase( glyphInfoIt );
+		}
+		else {
+			++glyphInfoIt;
+		}
+	}
+
+	for( const auto& sharedGlyph : sharedGlyphs ) {
+		auto glyphInfoIt = mGlyphInfo.find( sharedGlyph.second );
+		if( mGlyphInfo.end() != glyphInfoIt ) {
+			mGlyphInfo[sharedGlyph.first] = glyphInfoIt->second;
+		}
+	}
+	mNumSharedGlyphs = sharedGlyphs.size();
+	mSdfRange = static_cast<double>( format.getSdfRange() );
+	mSdfAngle = static_cast<double>( format.getSdfAngle() );
+	mComplete = false;
+	mBuildTime = timer.getSeconds();
+}
+
+SdfText::TextureAtlas::TextureAtlas( const TextureAtlas &source, const SdfText::Format &format )
+	: TextureAtlas( format )
 {
+	Timer timer( true );
 	const ivec2& tileSpacing = format.getSdfTileSpacing();
 
+	mFaces = source.mFaces;
+	mMaxGlyphSize = source.mMaxGlyphSize;
+	mMaxAscent = source.mMaxAscent;
+	mMaxDescent = source.mMaxDescent;
+	mNumSharedGlyphs = source.mNumSharedGlyphs;
+	// Same cell size as generating the glyphs at this scale
+	mSdfBitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( mSdfScale, mSdfPadding, mMaxGlyphSize );
+
+	// Glyphs sharing a source cell share the derived cell, cells keep the order of the source layout
+	using SourceCell = std::tuple<uint32_t, int32_t, int32_t>;
+	std::map<SourceCell, std::vector<GlyphKey>> sourceCells;
+	for( const auto& it : source.mGlyphInfo ) {
+		const GlyphInfo& glyphInfo = it.second;
+		sourceCells[std::make_tuple( glyphInfo.mTextureIndex, glyphInfo.mTexCoords.y1, glyphInfo.mTexCoords.x1 )].push_back( it.first );
+	}
+
+	if( format.getAutoTextureSize() ) {
+		RenderGlyph cell = {};
+		cell.bitmapSize = mSdfBitmapSize;
+		mTextureSize = SdfText::TextureAtlas::chooseTextureSize( std::vector<RenderGlyph>( sourceCells.size(), cell ), false, tileSpacing, format );
+	}
+
+	const size_t numGlyphColumns   = ( mTextureSize.x / ( mSdfBitmapSize.x + tileSpacing.x ) );
+	const size_t numGlyphRows      = ( mTextureSize.y / ( mSdfBitmapSize.y + tileSpacing.y ) );
+	const size_t numGlyphsPerAtlas = numGlyphColumns * numGlyphRows;
+	if( 0 == numGlyphsPerAtlas ) {
+		CI_LOG_W( "Texture size " << mTextureSize << " is too small for glyph cells of size " << mSdfBitmapSize );
+		return;
+	}
+
+	// Cells sit at the same spots on every page, only a partially filled last page needs clearing
+	Surface8u surface( mTextureSize.x, mTextureSize.y, false );
+	ip::fill( &surface, Color8u( 0, 0, 0 ) );
+	Surface8u sourceSurface( source.mTextureSize.x, source.mTextureSize.y, false );
+	uint32_t sourcePage = std::numeric_limits<uint32_t>::max();
+
+	const vec2 ratio = source.mSdfScale / mSdfScale;
+	const size_t numCells = sourceCells.size();
+	size_t cellIndex = 0;
+	for( const auto& sourceCell : sourceCells ) {
+		const GlyphInfo& sourceInfo = source.mGlyphInfo.at( sourceCell.second.front() );
+		if( sourceInfo.mTextureIndex != sourcePage ) {
+			sourcePage = sourceInfo.mTextureIndex;
+			if( ( sourcePage >= source.mCompressedPages.size() ) || ( ! AtlasPageCodec::decode( source.mCompressedPages[sourcePage], &sourceSurface ) ) ) {
+				CI_LOG_E( "Failed to decode atlas page " << sourcePage );
+				ip::fill( &sourceSurface, Color8u( 0, 0, 0 ) );
+			}
+		}
+
+		const size_t pageCellIndex = cellIndex % numGlyphsPerAtlas;
+		const ivec2 position = ivec2( 
+			static_cast<int32_t>( pageCellIndex % numGlyphColumns ) * ( mSdfBitmapSize.x + tileSpacing.x ),
+			static_cast<int32_t>( pageCellIndex / numGlyphColumns ) * ( mSdfBitmapSize.y + tileSpacing.y ) );
+		if( ( 0 == pageCellIndex ) && ( mNumPages > 0 ) && ( ( numCells - cellIndex ) < numGlyphsPerAtlas ) ) {
+			ip::fill( &surface, Color8u( 0, 0, 0 ) );
+		}
+		resampleSdfCell( sourceSurface, sourceInfo.mTexCoords, &surface, position, mSdfBitmapSize, ratio );
+
+		GlyphInfo glyphInfo;
+		glyphInfo.mTextureIndex = mNumPages;
+		glyphInfo.mTexCoords = Area( 0, 0, mSdfBitmapSize.x, mSdfBitmapSize.y ) + position;
+		glyphInfo.mOriginOffset = sourceInfo.mOriginOffset;
+		glyphInfo.mSdfScale = mSdfScale;
+		for( const auto& glyphKey : sourceCell.second ) {
+			mGlyphInfo[glyphKey] = glyphInfo;
+		}
+
+		++cellIndex;
+		if( ( numGlyphsPerAtlas == ( pageCellIndex + 1 ) ) || ( numCells == cellIndex ) ) {
+			if( mKeepCompressedPages ) {
+				mCompressedPages.push_back( AtlasPageCodec::encode( surface ) );
+			}
+			addPage( surface );
+		}
+	}
+	finishPages();
+	mBuildTime = timer.getSeconds();
+}
+
+void SdfText::TextureAtlas::addFace( FT_Face face, const std::string &utf8Chars )
+{
 	std::u32string utf32Chars = ci::toUtf32( utf8Chars );
 	// Add a space if needed
 	if( std::string::npos == utf8Chars.find( ' ' ) ) {
 		utf32Chars += ci::toUtf32( " " );
 	}
 
-	// Build the maps and information pieces that will be needed later
-	std::set<SdfText::Font::Glyph> glyphIndices;
+	FaceInfo faceInfo;
+	faceInfo.mFace = face;
+	FaceLock faceLock = lockFace( face );
+	// Character to glyph index and vice versa
 	for( const auto& ch : utf32Chars ) {
 		FT_UInt glyphIndex = FT_Get_Char_Index( face, static_cast<FT_ULong>( ch ) );
-		glyphIndices.insert( glyphIndex );
-
-		// Character to glyph index and vice versa
-		mCharToGlyph[static_cast<uint32_t>( ch )] = glyphIndex;
-		mGlyphToChar[glyphIndex] = static_cast<uint32_t>( ch );
-
-		// Glyph bounds, 
-		msdfgen::Shape shape;
-		if( msdfgen::loadGlyph( shape, face, glyphIndex ) ) {
-			double l, b, r, t;
-			l = b = r = t = 0.0;
-			shape.bounds( l, b, r, t );
-			// Glyph bounds
-			Rectf bounds = Rectf( 
-				static_cast<float>( l ), 
-				static_cast<float>( b ), 
-				static_cast<float>( r ), 
-				static_cast<float>( t ) );
-			mGlyphInfo[glyphIndex].mOriginOffset = vec2( l, b );
-			// Max glyph size
-			mMaxGlyphSize.x = std::max( mMaxGlyphSize.x, bounds.getWidth() );
-			mMaxGlyphSize.y = std::max( mMaxGlyphSize.y, bounds.getHeight() );
-			// Max ascent, descent
-			mMaxAscent = std::max( mMaxAscent, static_cast<float>( t ) );
-			mMaxDescent = std::max( mMaxAscent, static_cast<float>( std::fabs( b ) ) );
-			//CI_LOG_I( (char)ch << " : " << mGlyphInfo[glyphIndex].mOriginOffset );
-		}	
+		faceInfo.mCharToGlyph[static_cast<uint32_t>( ch )] = glyphIndex;
+		faceInfo.mGlyphToChar[glyphIndex] = static_cast<uint32_t>( ch );
 	}
+	mFaces.push_back( faceInfo );
+}
 
-	// Determine render bitmap size
-	mSdfBitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( mSdfScale, mSdfPadding, mMaxGlyphSize );
-	// Determine glyph counts (per texture atlas)
-	const size_t numGlyphColumns   = ( format.getTextureWidth()  / ( mSdfBitmapSize.x + tileSpacing.x ) );
-	const size_t numGlyphRows      = ( format.getTextureHeight() / ( mSdfBitmapSize.y + tileSpacing.y ) );
-	const size_t numGlyphsPerAtlas = numGlyphColumns * numGlyphRows;
-	
-	// Render position for each glyph
-	struct RenderGlyph {
-		uint32_t glyphIndex;
-		ivec2    position;
-	};
+void SdfText::TextureAtlas::addPage( const Surface8u &surface )
+{
+	// Texture array layers are uploaded by finishPages(), which allocates the array, 
+	// and atlases built on worker threads leave the upload to the GL thread
+	if( mIsTextureArray || ( nullptr == gl::context() ) ) {
+		mPendingPages.push_back( surface.clone() );
+	}
+	else {
+		gl::TextureRef tex = gl::Texture::create( surface );
+		mTextures.push_back( tex );
+	}
+	++mNumPages;
+	updateOwnGpuBytes();
+}
 
-	std::vector<std::vector<RenderGlyph>> renderAtlases;
-
-	// Build the atlases
-	size_t curRenderIndex = 0;
-	ivec2 curRenderPos = ivec2( 0 );
-	std::vector<RenderGlyph> curRenderGlyphs;
-	for( std::set<SdfText::Font::Glyph>::const_iterator glyphIndexIt = glyphIndices.begin(); glyphIndexIt != glyphIndices.end() ;  ) {
-		// Build render glyph
-		RenderGlyph renderGlyph;
-		renderGlyph.glyphIndex = *glyphIndexIt;
-		renderGlyph.position.x = curRenderPos.x;
-		renderGlyph.position.y = curRenderPos.y;
-		
-		// Add to render atlas
-		curRenderGlyphs.push_back( renderGlyph );
-
-		// Increment index
-		++curRenderIndex;
-		// Increment glyph index iterator
-		++glyphIndexIt;
-		// Advance horizontal position
-		curRenderPos.x += mSdfBitmapSize.x;
-		curRenderPos.x += tileSpacing.x;
-		// Move to next row if needed
-		if( 0 == ( curRenderIndex % numGlyphColumns ) ) {
-			curRenderPos.x = 0;
-			curRenderPos.y += mSdfBitmapSize.y;
-			curRenderPos.y += tileSpacing.y;
-		}
-
-		if( ( numGlyphsPerAtlas == curRenderIndex ) || ( glyphIndices.end() == glyphIndexIt ) ) {
-			// Copy current atlas
-			renderAtlases.push_back( curRenderGlyphs );
-			// Reset values
-			curRenderIndex = 0;
-			curRenderPos = ivec2( 0 );
-			curRenderGlyphs.clear();
-		}
-	}
-
-	// Surface
-	Surface8u surface( format.getTextureWidth(), format.getTextureHeight(), false );
+void SdfText::TextureAtlas::finishPages()
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	if( mPendingPages.empty() || ( nullptr == gl::context() ) ) {
+		return;
+	}
+
+	if( ! mIsTextureArray ) {
+		for( const auto& surface : mPendingPages ) {
+			mTextures.push_back( gl::Texture::create( surface ) );
+		}
+	}
+#if ! defined( CINDER_GL_ES_2 )
+	else {
+		// Layers are allocated for every page laid out, pages that are still being generated are filled in later
+		if( ! mTextureArray ) {
+			const uint32_t numLayers = std::max<uint32_t>( mNumPlannedPages, mNumPages );
+			auto texFormat = gl::Texture3d::Format().target( GL_TEXTURE_2D_ARRAY ).internalFormat( GL_RGB8 ).minFilter( GL_LINEAR ).magFilter( GL_LINEAR );
+			mTextureArray = gl::Texture3d::create( mTextureSize.x, mTextureSize.y, static_cast<GLint>( numLayers ), texFormat );
+		}
+		const size_t firstLayer = mNumPages - mPendingPages.size();
+		for( size_t i = 0; i < mPendingPages.size(); ++i ) {
+			mTextureArray->update( mPendingPages[i], static_cast<int>( firstLayer + i ) );
+		}
+	}
+#endif
+	mPendingPages.clear();
+	updateOwnGpuBytes();
+}
+
+void SdfText::TextureAtlas::generatePages()
+{
+	Timer timer( true );
+	std::vector<std::vector<RenderGlyph>> renderPages;
+	{
+		std::lock_guard<std::recursive_mutex> lock( mMutex );
+		renderPages.swap( mRenderPages );
+	}
+
+	// Surface, cleared once. Afterwards only the cells written by the previous page are cleared 
+	// unless the current page overwrites them completely with a cell at the same spot.
+	Surface8u surface( mTextureSize.x, mTextureSize.y, false );
 	ip::fill( &surface, Color8u( 0, 0, 0 ) );
 	uint8_t *surfaceData   = surface.getData();
 	size_t surfacePixelInc = surface.getPixelInc();
 	size_t surfaceRowBytes = surface.getRowBytes();
+	std::vector<Area> dirtyCells;
+
+	// Render the pages, the layout and glyph info are final so only the lock is needed to add a page
+	for( size_t pageIndex = 0; pageIndex < renderPages.size(); ++pageIndex ) {
+		const auto& renderGlyphs = renderPages[pageIndex];
+
+		// Clear what this page doesn't overwrite
+		if( ! dirtyCells.empty() ) {
+			auto areaLess = []( const Area& a, const Area& b ) { 
+				return std::make_tuple( a.x1, a.y1, a.x2, a.y2 ) < std::make_tuple( b.x1, b.y1, b.x2, b.y2 ); 
+			};
+			std::vector<Area> overwrittenCells;
+			for( const auto& renderGlyph : renderGlyphs ) {
+				overwrittenCells.push_back( Area( 0, 0, renderGlyph.bitmapSize.x, renderGlyph.bitmapSize.y ) + renderGlyph.position );
+			}
+			std::sort( overwrittenCells.begin(), overwrittenCells.end(), areaLess );
+			for( const auto& dirtyCell : dirtyCells ) {
+				if( ! std::binary_search( overwrittenCells.begin(), overwrittenCells.end(), dirtyCell, areaLess ) ) {
+					ip::fill( &surface, Color8u( 0, 0, 0 ), dirtyCell );
+				}
+			}
+			dirtyCells.clear();
+		}
 
-	// Render the atlases
-	const double sdfRange = static_cast<double>( format.getSdfRange() );
-	const double sdfAngle = static_cast<double>( format.getSdfAngle() );
-	msdfgen::Bitmap<msdfgen::FloatRGB> sdfBitmap( mSdfBitmapSize.x, mSdfBitmapSize.y );
-	uint32_t currentTextureIndex = 0;
-	for( size_t atlasIndex = 0; atlasIndex < renderAtlases.size(); ++atlasIndex ) {
-		const auto& renderGlyphs = renderAtlases[atlasIndex];
-		// Render atlas
+		// Render page
 		for( const auto& renderGlyph : renderGlyphs ) {
+			FT_Face face = mFaces[renderGlyph.faceSlot].mFace;
+			const Area cellArea = Area( 0, 0, renderGlyph.bitmapSize.x, renderGlyph.bitmapSize.y ) + renderGlyph.position;
+			GlyphInfo glyphInfo;
+			bool loaded = findGlyphInfo( makeGlyphKey( renderGlyph.faceSlot, renderGlyph.glyphIndex ), &glyphInfo, false );
 			msdfgen::Shape shape;
-			if( msdfgen::loadGlyph( shape, face, renderGlyph.glyphIndex ) ) {
-				shape.inverseYAxis = true;
-				shape.normalize();	
+			if( loaded ) {
+				// Only the outline is read from the face, the distance field is generated without holding it
+				FaceLock faceLock = lockFace( face );
+				loaded = msdfgen::loadGlyph( shape, face, renderGlyph.glyphIndex );
+			}
+			if( ! loaded ) {
+				// The cell was assumed to be overwritten and may still hold a glyph of the previous page
+				ip::fill( &surface, Color8u( 0, 0, 0 ), cellArea );
+				continue;
+			}
+
+			shape.inverseYAxis = true;
+			shape.normalize();	
+			
+			// Edge color
+			msdfgen::edgeColoringSimple( shape, mSdfAngle );
 				
-				// Edge color
-				msdfgen::edgeColoringSimple( shape, sdfAngle );
-					
-				// Generate SDF
-				vec2 originOffset = mGlyphInfo[renderGlyph.glyphIndex].mOriginOffset;
-				float tx = mSdfPadding.x;
-				float ty = std::fabs( originOffset.y ) + mSdfPadding.y;
-				// mSdfScale will get applied to <tx, ty> by msdfgen
-				msdfgen::generateMSDF( sdfBitmap, shape, sdfRange, msdfgen::Vector2( mSdfScale.x, mSdfScale.y ), msdfgen::Vector2( tx, ty ) );
-
-				// Copy bitmap
-				size_t dstOffset = ( renderGlyph.position.y * surfaceRowBytes ) + ( renderGlyph.position.x * surfacePixelInc );
-				uint8_t *dst = surfaceData + dstOffset;
-				for( int n = 0; n < mSdfBitmapSize.y; ++n ) {
-					Color8u *dstPixel = reinterpret_cast<Color8u *>( dst );
-					for( int m = 0; m < mSdfBitmapSize.x; ++m ) {
-						msdfgen::FloatRGB &src = sdfBitmap( m, n );
-						Color srcPixel = Color( src.r, src.g, src.b );
-						*dstPixel = srcPixel;
-						++dstPixel;
-					}
-					dst += surfaceRowBytes;
-				}
+			// Generate SDF
+			const vec2& sdfScale = renderGlyph.sdfScale;
+			const ivec2& bitmapSize = renderGlyph.bitmapSize;
+			const vec2& originOffset = glyphInfo.mOriginOffset;
+			float tx = mSdfPadding.x;
+			float ty = std::fabs( originOffset.y ) + mSdfPadding.y;
+			// sdfScale will get applied to <tx, ty> by msdfgen
+			msdfgen::Bitmap<msdfgen::FloatRGB> sdfBitmap( bitmapSize.x, bitmapSize.y );
+			msdfgen::generateMSDF( sdfBitmap, shape, mSdfRange, msdfgen::Vector2( sdfScale.x, sdfScale.y ), msdfgen::Vector2( tx, ty ) );
+
+			// Copy bitmap
+			size_t dstOffset = ( renderGlyph.position.y * surfaceRowBytes ) + ( renderGlyph.position.x * surfacePixelInc );
+			copySdfBitmap( sdfBitmap, surfaceData + dstOffset, surfaceRowBytes );
+			dirtyCells.push_back( cellArea );
+		}
 
-				// Tex coords
-				mGlyphInfo[renderGlyph.glyphIndex].mTextureIndex = currentTextureIndex;
-				mGlyphInfo[renderGlyph.glyphIndex].mTexCoords = Area( 0, 0, mSdfBitmapSize.x, mSdfBitmapSize.y ) + renderGlyph.position;
+		// Add the page, its glyphs are found from here on and drawn once it's uploaded
+		AtlasPageCodec::Page compressedPage;
+		if( mKeepCompressedPages ) {
+			compressedPage = AtlasPageCodec::encode( surface );
+		}
+		{
+			std::lock_guard<std::recursive_mutex> lock( mMutex );
+			if( mKeepCompressedPages ) {
+				mCompressedPages.push_back( std::move( compressedPage ) );
 			}
+			addPage( surface );
 		}
-		// Create texture
-		gl::TextureRef tex = gl::Texture::create( surface );
-		mTextures.push_back( tex );
-		++currentTextureIndex;
 
 		// Debug output
-		//writeImage( "sdfText_" + std::to_string( atlasIndex ) + ".png", surface );
-
-		// Reset
-		ip::fill( &surface, Color8u( 0, 0, 0 ) );		
+		//writeImage( "sdfText_" + std::to_string( pageIndex ) + ".png", surface );
 	}
+	finishPages();
+
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	mBuildTime += timer.getSeconds();
 }
 
-SdfText::TextureAtlasRef SdfText::TextureAtlas::create( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars )
+void SdfText::TextureAtlas::completePages()
 {
-	SdfText::TextureAtlasRef result = SdfText::TextureAtlasRef( new SdfText::TextureAtlas( face, format, utf8Chars ) );
-	return result;
+	{
+		std::lock_guard<std::recursive_mutex> lock( mMutex );
+		mComplete = true;
+	}
+	mCompleteCondition.notify_all();
 }
 
-cinder::ivec2 SdfText::TextureAtlas::calculateSdfBitmapSize( const vec2 &sdfScale, const ivec2& sdfPadding, const vec2 &maxGlyphSize )
+void SdfText::TextureAtlas::waitUntilComplete() const
 {
-	ivec2 result = ivec2( ( sdfScale * ( maxGlyphSize + ( 2.0f * vec2( sdfPadding ) ) ) ) + vec2( 0.5f ) );
-	return result;
+	std::unique_lock<std::recursive_mutex> lock( mMutex );
+	mCompleteCondition.wait( lock, [this]() { return mComplete; } );
 }
 
-// =================================================================================================
-// SdfTextManager
-// =================================================================================================
-class SdfTextManager {
-public:
-	~SdfTextManager();
-
-	static SdfTextManager			*instance();
+void SdfText::TextureAtlas::initDynamic( const std::vector<FT_Face> &faces, const SdfText::Format &format )
+{
+	mDynamic = true;
+	mKeepCompressedPages = false;
+	mMaxPages = format.getMaxPages();
+	mTileSpacing = format.getSdfTileSpacing();
+	mSdfRange = static_cast<double>( format.getSdfRange() );
+	mSdfAngle = static_cast<double>( format.getSdfAngle() );
+
+	// The glyphs aren't known up front, so the cells are sized by the font bounding boxes. 
+	// Outlines are loaded unscaled in 26.6, see msdfgen::loadGlyph().
+	for( const auto& face : faces ) {
+		const FT_BBox& bbox = face->bbox;
+		mMaxGlyphSize.x = std::max( mMaxGlyphSize.x, static_cast<float>( bbox.xMax - bbox.xMin ) / 64.0f );
+		mMaxGlyphSize.y = std::max( mMaxGlyphSize.y, static_cast<float>( bbox.yMax - bbox.yMin ) / 64.0f );
+		mMaxAscent = std::max( mMaxAscent, static_cast<float>( bbox.yMax ) / 64.0f );
+		mMaxDescent = std::max( mMaxDescent, static_cast<float>( std::abs( bbox.yMin ) ) / 64.0f );
+	}
+	mSdfBitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( mSdfScale, mSdfPadding, mMaxGlyphSize );
 
-	FT_Library						getLibrary() const { return mLibrary; }
+	const size_t numGlyphColumns = ( mTextureSize.x / ( mSdfBitmapSize.x + mTileSpacing.x ) );
+	const size_t numGlyphRows    = ( mTextureSize.y / ( mSdfBitmapSize.y + mTileSpacing.y ) );
+	mNumCellsPerPage = numGlyphColumns * numGlyphRows;
+	if( 0 == mNumCellsPerPage ) {
+		CI_LOG_W( "Texture size " << mTextureSize << " is too small for glyph cells of size " << mSdfBitmapSize );
+	}
+}
 
-	const std::vector<std::string>&	getNames( bool forceRefresh );
-	SdfText::Font					getDefault() const;
+void SdfText::TextureAtlas::initUnicodeBlocks( const SdfText::Format &format )
+{
+	mUnicodeBlocks = true;
+	mKeepCompressedPages = false;
+	// Blocks are separate static atlases whose textures are shared as they are
+	mIsTextureArray = false;
+	mBlockFormat = format;
+	mBlockFormat.unicodeBlocks( false ).textureArray( false ).autoTextureSize( false );
+}
 
-	struct FontInfo {
-		std::string 	key;
-		std::string 	name;
-		fs::path 		path;
-		FontInfo() {}
-		FontInfo( const std::string& aKey, const std::string& aName, const fs::path& aPath ) 
-			: key( aKey ), name( aName ), path( aPath ) {}
-	};
+void SdfText::TextureAtlas::mapUnicodeBlocks()
+{
+	// Walking the character maps takes a few milliseconds for large CJK fonts, so it's left to the first miss
+	std::unordered_set<uint32_t> mappedChars;
+	mGlyphBlocks.resize( mFaces.size() );
+	for( size_t faceSlot = 0; faceSlot < mFaces.size(); ++faceSlot ) {
+		FT_Face face = mFaces[faceSlot].mFace;
+		FaceLock faceLock = lockFace( face );
+		FT_UInt glyphIndex = 0;
+		FT_ULong ch = FT_Get_First_Char( face, &glyphIndex );
+		while( 0 != glyphIndex ) {
+			const uint32_t block = getUnicodeBlock( static_cast<uint32_t>( ch ) );
+			mGlyphBlocks[faceSlot].insert( std::make_pair( static_cast<SdfText::Font::Glyph>( glyphIndex ), block ) );
+			if( mappedChars.insert( static_cast<uint32_t>( ch ) ).second ) {
+				mBlockChars[block] += static_cast<char32_t>( ch );
+			}
+			ch = FT_Get_Next_Char( face, ch, &glyphIndex );
+		}
+	}
+}
 
-	FontInfo 						getFontInfo( const std::string& fontName ) const;
+void SdfText::TextureAtlas::addUnicodeBlock( const TextureAtlas &block )
+{
+	std::lock_guard<std::recursive_mutex> blockLock( block.mMutex );
+	const uint32_t pageOffset = mNumPages;
+	mTextures.insert( std::end( mTextures ), std::begin( block.mTextures ), std::end( block.mTextures ) );
+	mNumPages += block.mNumPages;
+	// Glyphs reached by characters of several blocks are in each of them, either copy will do
+	for( const auto& it : block.mGlyphInfo ) {
+		GlyphInfo glyphInfo = it.second;
+		glyphInfo.mTextureIndex += pageOffset;
+		mGlyphInfo[it.first] = glyphInfo;
+	}
+	mMaxGlyphSize.x = std::max( mMaxGlyphSize.x, block.mMaxGlyphSize.x );
+	mMaxGlyphSize.y = std::max( mMaxGlyphSize.y, block.mMaxGlyphSize.y );
+	mMaxAscent = std::max( mMaxAscent, block.mMaxAscent );
+	mMaxDescent = std::max( mMaxDescent, block.mMaxDescent );
+}
 
-private:
-	SdfTextManager();
+bool SdfText::TextureAtlas::allocateCell( Cell *cell )
+{
+	// Add a page if all cells are taken
+	if( mFreeCells.empty() && ( mNumPages < mMaxPages ) && ( mNumCellsPerPage > 0 ) ) {
+		const uint32_t page = mNumPages;
+		Surface8u surface( mTextureSize.x, mTextureSize.y, false );
+		ip::fill( &surface, Color8u( 0, 0, 0 ) );
+		if( mIsTextureArray ) {
+#if ! defined( CINDER_GL_ES_2 )
+			// Doubles the layers so adding pages one by one copies each layer only a few times
+			if( ( ! mTextureArray ) || ( static_cast<uint32_t>( mTextureArray->getDepth() ) <= page ) ) {
+				resizeTextureArray( std::min<uint32_t>( mMaxPages, std::max<uint32_t>( 1, 2 * page ) ) );
+			}
+			mTextureArray->update( surface, static_cast<int>( page ) );
+#endif
+		}
+		else {
+			mTextures.push_back( gl::Texture::create( surface ) );
+		}
+		++mNumPages;
+		updateOwnGpuBytes();
+
+		// Fill the free list in reverse so cells are handed out row by row
+		const size_t numGlyphColumns = ( mTextureSize.x / ( mSdfBitmapSize.x + mTileSpacing.x ) );
+		for( size_t i = mNumCellsPerPage; i > 0; --i ) {
+			const size_t index = i - 1;
+			Cell freeCell;
+			freeCell.mPage = page;
+			freeCell.mPosition.x = static_cast<int32_t>( index % numGlyphColumns ) * ( mSdfBitmapSize.x + mTileSpacing.x );
+			freeCell.mPosition.y = static_cast<int32_t>( index / numGlyphColumns ) * ( mSdfBitmapSize.y + mTileSpacing.y );
+			mFreeCells.push_back( freeCell );
+		}
+	}
+
+	while( mFreeCells.empty() && evictLeastRecentlyUsedGlyph() ) {
+	}
+
+	if( mFreeCells.empty() ) {
+		return false;
+	}
+
+	*cell = mFreeCells.back();
+	mFreeCells.pop_back();
+	return true;
+}
+
+SdfText::TextureAtlas::OutlineKey SdfText::TextureAtlas::OutlineKey::create( FT_Face face )
+{
+	const FT_Outline& outline = face->glyph->outline;
+	OutlineKey result;
+	result.mPoints.assign( outline.points, outline.points + outline.n_points );
+	result.mTags.assign( outline.tags, outline.tags + outline.n_points );
+	result.mContours.assign( outline.contours, outline.contours + outline.n_contours );
+	return result;
+}
+
+bool SdfText::TextureAtlas::OutlineKey::operator==( const OutlineKey& rhs ) const
+{
+	if( ( mPoints.size() != rhs.mPoints.size() ) || ( mTags != rhs.mTags ) || ( mContours != rhs.mContours ) ) {
+		return false;
+	}
+	for( size_t i = 0; i < mPoints.size(); ++i ) {
+		if( ( mPoints[i].x != rhs.mPoints[i].x ) || ( mPoints[i].y != rhs.mPoints[i].y ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SdfText::TextureAtlas::evictLeastRecentlyUsedGlyph()
+{
+	if( mGlyphLru.empty() ) {
+		return false;
+	}
+	auto glyphInfoIt = mGlyphInfo.find( mGlyphLru.front() );
+	const GlyphInfo& glyphInfo = glyphInfoIt->second;
+	if( mUseTick == glyphInfo.mLastUse ) {
+		return false;
+	}
+
+	auto outlineCellIt = mOutlineCells.find( *glyphInfo.mOutline );
+	if( 0 == --outlineCellIt->second.mRefCount ) {
+		Cell cell;
+		cell.mPage = glyphInfo.mTextureIndex;
+		cell.mPosition = glyphInfo.mTexCoords.getUL();
+		mFreeCells.push_back( cell );
+		mOutlineCells.erase( outlineCellIt );
+	}
+
+	mGlyphLru.pop_front();
+	mGlyphInfo.erase( glyphInfoIt );
+	++mNumEvictions;
+	return true;
+}
+
+void SdfText::TextureAtlas::renderGlyph( msdfgen::Shape &shape, const Cell &cell, GlyphInfo *glyphInfo )
+{
+	Timer timer( true );
+	double l, b, r, t;
+	l = b = r = t = 0.0;
+	shape.bounds( l, b, r, t );
+	glyphInfo->mOriginOffset = vec2( l, b );
+
+	shape.inverseYAxis = true;
+	shape.normalize();	
+	msdfgen::edgeColoringSimple( shape, mSdfAngle );
+
+	// Same transform as the glyphs of a static atlas
+	float tx = mSdfPadding.x;
+	float ty = std::fabs( glyphInfo->mOriginOffset.y ) + mSdfPadding.y;
+	msdfgen::Bitmap<msdfgen::FloatRGB> sdfBitmap( mSdfBitmapSize.x, mSdfBitmapSize.y );
+	msdfgen::generateMSDF( sdfBitmap, shape, mSdfRange, msdfgen::Vector2( mSdfScale.x, mSdfScale.y ), msdfgen::Vector2( tx, ty ) );
+
+	std::vector<Color8u> pixels( static_cast<size_t>( mSdfBitmapSize.x * mSdfBitmapSize.y ) );
+	copySdfBitmap( sdfBitmap, reinterpret_cast<uint8_t *>( pixels.data() ), 3 * static_cast<size_t>( mSdfBitmapSize.x ) );
+
+	// Cell rows are tightly packed RGB
+	GLint prevUnpackAlignment = 4;
+	glGetIntegerv( GL_UNPACK_ALIGNMENT, &prevUnpackAlignment );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GL_ES_2 )
+	if( mIsTextureArray ) {
+		mTextureArray->update( pixels.data(), GL_RGB, GL_UNSIGNED_BYTE, 0, mSdfBitmapSize.x, mSdfBitmapSize.y, 1, cell.mPosition.x, cell.mPosition.y, static_cast<int>( cell.mPage ) );
+	}
+	else
+#endif
+	{
+		mTextures[cell.mPage]->update( pixels.data(), GL_RGB, GL_UNSIGNED_BYTE, 0, mSdfBitmapSize.x, mSdfBitmapSize.y, cell.mPosition.x, cell.mPosition.y );
+	}
+	glPixelStorei( GL_UNPACK_ALIGNMENT, prevUnpackAlignment );
+
+	glyphInfo->mTextureIndex = cell.mPage;
+	glyphInfo->mTexCoords = Area( 0, 0, mSdfBitmapSize.x, mSdfBitmapSize.y ) + cell.mPosition;
+	glyphInfo->mSdfScale = mSdfScale;
+	mBuildTime += timer.getSeconds();
+}
+
+bool SdfText::TextureAtlas::findGlyphInfo( GlyphKey glyphKey, GlyphInfo *result, bool generatedOnly ) const
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	auto glyphInfoIt = mGlyphInfo.find( glyphKey );
+	if( ( mGlyphInfo.end() == glyphInfoIt ) || ( generatedOnly && ( glyphInfoIt->second.mTextureIndex >= mNumPages ) ) ) {
+		return false;
+	}
+	*result = glyphInfoIt->second;
+	return true;
+}
+
+const SdfText::TextureAtlas::GlyphInfo* SdfText::TextureAtlas::acquireGlyph( uint32_t faceSlot, SdfText::Font::Glyph glyph )
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	const GlyphKey glyphKey = makeGlyphKey( faceSlot, glyph );
+	auto glyphInfoIt = mGlyphInfo.find( glyphKey );
+	if( mGlyphInfo.end() != glyphInfoIt ) {
+		// The pages of a static atlas are published as they're generated, staged pages are the last ones
+		if( glyphInfoIt->second.mTextureIndex >= ( mNumPages - static_cast<uint32_t>( mPendingPages.size() ) ) ) {
+			return nullptr;
+		}
+		if( mDynamic ) {
+			glyphInfoIt->second.mLastUse = mUseTick;
+			mGlyphLru.splice( mGlyphLru.end(), mGlyphLru, glyphInfoIt->second.mLruIt );
+		}
+		++mNumHits;
+		return &( glyphInfoIt->second );
+	}
+
+	// Try again once the block of the glyph is in, a block is only loaded once
+	if( mUnicodeBlocks && ( faceSlot < mFaces.size() ) && loadUnicodeBlock( faceSlot, glyph ) ) {
+		return acquireGlyph( faceSlot, glyph );
+	}
+
+	if( ( ! mDynamic ) || ( faceSlot >= mFaces.size() ) ) {
+		++mNumFailures;
+		return nullptr;
+	}
+
+	// Glyphs without an outline, like the space, have nothing to draw and don't take up a cell
+	if( mUnavailableGlyphs.end() != mUnavailableGlyphs.find( glyphKey ) ) {
+		return nullptr;
+	}
+	msdfgen::Shape shape;
+	OutlineKey outline;
+	{
+		// The outline key is read from the glyph slot, which other threads overwrite once the face is unlocked
+		FaceLock faceLock = lockFace( mFaces[faceSlot].mFace );
+		if( ( ! msdfgen::loadGlyph( shape, mFaces[faceSlot].mFace, glyph ) ) || shape.contours.empty() ) {
+			mUnavailableGlyphs.insert( glyphKey );
+			return nullptr;
+		}
+		outline = OutlineKey::create( mFaces[faceSlot].mFace );
+	}
+
+	// Share the cell of a resident glyph with the same outline...
+	GlyphInfo glyphInfo;
+	auto outlineCellIt = mOutlineCells.find( outline );
+	if( mOutlineCells.end() != outlineCellIt ) {
+		glyphInfo = outlineCellIt->second.mGlyphInfo;
+		++outlineCellIt->second.mRefCount;
+		++mNumSharedGlyphs;
+	}
+	// ...or render it into a cell of its own
+	else {
+		Cell cell;
+		if( ! allocateCell( &cell ) ) {
+			++mNumFailures;
+			return nullptr;
+		}
+		renderGlyph( shape, cell, &glyphInfo );
+		OutlineCell outlineCell;
+		outlineCell.mGlyphInfo = glyphInfo;
+		outlineCell.mRefCount = 1;
+		outlineCellIt = mOutlineCells.insert( std::make_pair( std::move( outline ), outlineCell ) ).first;
+		++mNumMisses;
+	}
+	glyphInfo.mOutline = &( outlineCellIt->first );
+	glyphInfo.mLastUse = mUseTick;
+	glyphInfo.mLruIt = mGlyphLru.insert( mGlyphLru.end(), glyphKey );
+
+	auto result = mGlyphInfo.insert( std::make_pair( glyphKey, glyphInfo ) );
+	return &( result.first->second );
+}
+
+SdfText::GlyphResidencyStats SdfText::TextureAtlas::getGlyphResidencyStats() const
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	SdfText::GlyphResidencyStats result;
+	result.hits = mNumHits;
+	result.misses = mNumMisses;
+	result.evictions = mNumEvictions;
+	result.failures = mNumFailures;
+	result.sharedGlyphs = mNumSharedGlyphs;
+	result.residentGlyphs = mGlyphInfo.size();
+	result.capacity = mDynamic ? ( mNumCellsPerPage * mMaxPages ) : mGlyphInfo.size();
+	result.compactionMoves = mNumCompactionMoves;
+	return result;
+}
+
+bool SdfText::TextureAtlas::canReleasePage() const
+{
+	if( ( ! mDynamic ) || ( mNumPages < 2 ) ) {
+		return false;
+	}
+	const size_t numUsedCells = mNumPages * mNumCellsPerPage - mFreeCells.size();
+	return numUsedCells <= ( mNumPages - 1 ) * mNumCellsPerPage;
+}
+
+bool SdfText::TextureAtlas::compact( size_t maxCellMoves, uint64_t maxIdleUses )
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	if( ! mDynamic ) {
+		return false;
+	}
+
+	// The LRU list is ordered by last use, so the idle glyphs are at its front
+	if( maxIdleUses > 0 ) {
+		while( ( ! mGlyphLru.empty() ) && ( ( mUseTick - mGlyphInfo.at( mGlyphLru.front() ).mLastUse ) > maxIdleUses ) ) {
+			if( ! evictLeastRecentlyUsedGlyph() ) {
+				break;
+			}
+		}
+	}
+
+	GLuint fbo = 0;
+	size_t numMoves = 0;
+	while( canReleasePage() && ( numMoves < maxCellMoves ) ) {
+		const uint32_t lastPage = mNumPages - 1;
+
+		// Glyphs by the cell they share
+		std::unordered_map<const OutlineKey *, std::vector<GlyphInfo *>> cellGlyphs;
+		for( auto& it : mGlyphInfo ) {
+			if( lastPage == it.second.mTextureIndex ) {
+				cellGlyphs[it.second.mOutline].push_back( &( it.second ) );
+			}
+		}
+
+		for( auto& it : mOutlineCells ) {
+			GlyphInfo& cellInfo = it.second.mGlyphInfo;
+			if( ( lastPage != cellInfo.mTextureIndex ) || ( numMoves >= maxCellMoves ) ) {
+				continue;
+			}
+			// Any free cell on another page will do, there are enough of them
+			auto freeCellIt = std::find_if( mFreeCells.begin(), mFreeCells.end(), [lastPage]( const Cell& cell ) { return cell.mPage != lastPage; } );
+			if( mFreeCells.end() == freeCellIt ) {
+				break;
+			}
+			const Cell dst = *freeCellIt;
+			mFreeCells.erase( freeCellIt );
+
+			Cell src;
+			src.mPage = lastPage;
+			src.mPosition = cellInfo.mTexCoords.getUL();
+			if( 0 == fbo ) {
+				glGenFramebuffers( 1, &fbo );
+			}
+			copyCell( src, dst, fbo );
+
+			cellInfo.mTextureIndex = dst.mPage;
+			cellInfo.mTexCoords = Area( 0, 0, mSdfBitmapSize.x, mSdfBitmapSize.y ) + dst.mPosition;
+			for( auto& glyphInfo : cellGlyphs[&( it.first )] ) {
+				glyphInfo->mTextureIndex = cellInfo.mTextureIndex;
+				glyphInfo->mTexCoords = cellInfo.mTexCoords;
+			}
+			++numMoves;
+			++mNumCompactionMoves;
+		}
+
+		// Release the last page once every cell moved off it
+		const bool lastPageUsed = std::any_of( mOutlineCells.begin(), mOutlineCells.end(), [lastPage]( const OutlineCellMap::value_type& cell ) { 
+			return cell.second.mGlyphInfo.mTextureIndex == lastPage; 
+		} );
+		if( lastPageUsed ) {
+			break;
+		}
+		mFreeCells.erase( std::remove_if( mFreeCells.begin(), mFreeCells.end(), [lastPage]( const Cell& cell ) { return cell.mPage == lastPage; } ), mFreeCells.end() );
+		// The texture array gives back the layers once compacting is done
+		if( ! mIsTextureArray ) {
+			mTextures.pop_back();
+		}
+		--mNumPages;
+	}
+
+	if( 0 != fbo ) {
+		glDeleteFramebuffers( 1, &fbo );
+	}
+#if ! defined( CINDER_GL_ES_2 )
+	const uint32_t numLayers = std::max<uint32_t>( 1, mNumPages );
+	if( mIsTextureArray && mTextureArray && ( static_cast<uint32_t>( mTextureArray->getDepth() ) > numLayers ) ) {
+		resizeTextureArray( numLayers );
+	}
+#endif
+	updateOwnGpuBytes();
+	return canReleasePage();
+}
+
+void SdfText::TextureAtlas::copyCell( const Cell &src, const Cell &dst, GLuint fbo )
+{
+	gl::ScopedFramebuffer fboScp( GL_FRAMEBUFFER, fbo );
+#if ! defined( CINDER_GL_ES_2 )
+	if( mIsTextureArray ) {
+		glFramebufferTextureLayer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, mTextureArray->getId(), 0, static_cast<GLint>( src.mPage ) );
+		gl::ScopedTextureBind texBindScp( mTextureArray );
+		glCopyTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, dst.mPosition.x, dst.mPosition.y, static_cast<GLint>( dst.mPage ), src.mPosition.x, src.mPosition.y, mSdfBitmapSize.x, mSdfBitmapSize.y );
+		return;
+	}
+#endif
+	glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTextures[src.mPage]->getId(), 0 );
+	gl::ScopedTextureBind texBindScp( mTextures[dst.mPage] );
+	glCopyTexSubImage2D( GL_TEXTURE_2D, 0, dst.mPosition.x, dst.mPosition.y, src.mPosition.x, src.mPosition.y, mSdfBitmapSize.x, mSdfBitmapSize.y );
+}
+
+#if ! defined( CINDER_GL_ES_2 )
+void SdfText::TextureAtlas::resizeTextureArray( uint32_t numLayers )
+{
+	auto texFormat = gl::Texture3d::Format().target( GL_TEXTURE_2D_ARRAY ).internalFormat( GL_RGB8 ).minFilter( GL_LINEAR ).magFilter( GL_LINEAR );
+	gl::Texture3dRef textureArray = gl::Texture3d::create( mTextureSize.x, mTextureSize.y, static_cast<GLint>( numLayers ), texFormat );
+
+	const uint32_t numCopiedLayers = mTextureArray ? std::min<uint32_t>( mNumPages, numLayers ) : 0;
+	if( numCopiedLayers > 0 ) {
+		GLuint fbo = 0;
+		glGenFramebuffers( 1, &fbo );
+		{
+			gl::ScopedFramebuffer fboScp( GL_FRAMEBUFFER, fbo );
+			gl::ScopedTextureBind texBindScp( textureArray );
+			for( uint32_t layer = 0; layer < numCopiedLayers; ++layer ) {
+				glFramebufferTextureLayer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, mTextureArray->getId(), 0, static_cast<GLint>( layer ) );
+				glCopyTexSubImage3D( GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>( layer ), 0, 0, mTextureSize.x, mTextureSize.y );
+			}
+		}
+		glDeleteFramebuffers( 1, &fbo );
+	}
+
+	mTextureArray = textureArray;
+}
+#endif
+
+uint64_t SdfText::TextureAtlas::getNumCellTexels( size_t *numCells ) const
+{
+	// Glyphs sharing a cell point at the same area
+	std::set<std::tuple<uint32_t, int32_t, int32_t>> cells;
+	uint64_t result = 0;
+	for( const auto& it : mGlyphInfo ) {
+		const GlyphInfo& glyphInfo = it.second;
+		if( cells.insert( std::make_tuple( glyphInfo.mTextureIndex, glyphInfo.mTexCoords.x1, glyphInfo.mTexCoords.y1 ) ).second ) {
+			result += static_cast<uint64_t>( glyphInfo.mTexCoords.getWidth() ) * static_cast<uint64_t>( glyphInfo.mTexCoords.getHeight() );
+		}
+	}
+	if( nullptr != numCells ) {
+		*numCells = cells.size();
+	}
+	return result;
+}
+
+uint64_t SdfText::TextureAtlas::getNumTexels() const
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	return static_cast<uint64_t>( mNumPages ) * static_cast<uint64_t>( mTextureSize.x ) * static_cast<uint64_t>( mTextureSize.y );
+}
+
+SdfText::AtlasLayout SdfText::TextureAtlas::getAtlasLayout() const
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	SdfText::AtlasLayout result;
+	result.textureSize = mTextureSize;
+	result.numPages = mNumPages;
+	const uint64_t numCellTexels = getNumCellTexels( &result.numCells );
+	const uint64_t numTexels = getNumTexels();
+	result.fillRatio = ( numTexels > 0 ) ? static_cast<float>( static_cast<double>( numCellTexels ) / static_cast<double>( numTexels ) ) : 0.0f;
+	return result;
+}
+
+SdfText::AtlasStats SdfText::TextureAtlas::getAtlasStats() const
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	SdfText::AtlasStats result;
+	result.layout = getAtlasLayout();
+	result.cellSize = ( mAdaptiveSdfScale || mUnicodeBlocks ) ? ivec2( 0 ) : mSdfBitmapSize;
+	result.wastedTexels = getNumTexels() - std::min( getNumCellTexels( nullptr ), getNumTexels() );
+	result.numGlyphs = mGlyphInfo.size();
+	result.gpuBytes = getGpuBytes();
+	result.cpuBytes = getCpuBytes();
+	result.mapBytes = getMapBytes();
+	result.buildTime = mBuildTime;
+	return result;
+}
+
+size_t SdfText::TextureAtlas::getMapBytes() const
+{
+	// Hash map nodes hold the value and a next pointer, plus a pointer per bucket
+	const size_t nodeBytes = sizeof( void * );
+	size_t result = mGlyphInfo.size() * ( sizeof( GlyphInfoMap::value_type ) + nodeBytes ) + mGlyphInfo.bucket_count() * sizeof( void * );
+	for( const auto& face : mFaces ) {
+		result += face.mCharToGlyph.size() * ( sizeof( CharToGlyphMap::value_type ) + nodeBytes ) + face.mCharToGlyph.bucket_count() * sizeof( void * );
+		result += face.mGlyphToChar.size() * ( sizeof( GlyphToCharMap::value_type ) + nodeBytes ) + face.mGlyphToChar.bucket_count() * sizeof( void * );
+	}
+	result += mOutlineCells.size() * ( sizeof( OutlineCellMap::value_type ) + nodeBytes ) + mOutlineCells.bucket_count() * sizeof( void * );
+	for( const auto& it : mOutlineCells ) {
+		const OutlineKey& outline = it.first;
+		result += outline.mPoints.capacity() * sizeof( FT_Vector ) + outline.mTags.capacity() * sizeof( char ) + outline.mContours.capacity() * sizeof( short );
+	}
+	result += mUnavailableGlyphs.size() * ( sizeof( GlyphKey ) + nodeBytes ) + mUnavailableGlyphs.bucket_count() * sizeof( void * );
+	// List nodes have two pointers
+	result += mGlyphLru.size() * ( sizeof( GlyphKey ) + 2 * sizeof( void * ) );
+	result += mFreeCells.capacity() * sizeof( Cell );
+	return result;
+}
+
+SdfText::TextureAtlasRef SdfText::TextureAtlas::create( const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const GlyphIndices &glyphs )
+{
+	SdfText::TextureAtlasRef result = SdfText::TextureAtlasRef( new SdfText::TextureAtlas( faces, format, utf8Chars, glyphs ) );
+	return result;
+}
+
+SdfText::TextureAtlasRef SdfText::TextureAtlas::createDerived( const TextureAtlas &source, const SdfText::Format &format )
+{
+	SdfText::TextureAtlasRef result = SdfText::TextureAtlasRef( new SdfText::TextureAtlas( source, format ) );
+	return result;
+}
+
+cinder::ivec2 SdfText::TextureAtlas::calculateSdfBitmapSize( const vec2 &sdfScale, const ivec2& sdfPadding, const vec2 &maxGlyphSize )
+{
+	ivec2 result = ivec2( ( sdfScale * ( maxGlyphSize + ( 2.0f * vec2( sdfPadding ) ) ) ) + vec2( 0.5f ) );
+	return result;
+}
+
+float SdfText::TextureAtlas::calculateAdaptiveSdfScale( const msdfgen::Shape &shape, const SdfText::Format &format )
+{
+	// Edge counts of Roboto range from 4 for "l" to about 50 for "@", CJK ideographs have far more
+	static const double kSimpleNumEdges = 8.0;
+	static const double kComplexNumEdges = 48.0;
+	// Smallest contour extent (roughly the stroke width) that should still span this many texels
+	static const double kMinFeatureTexels = 2.0;
+
+	size_t numEdges = 0;
+	double minFeatureSize = std::numeric_limits<double>::max();
+	for( const auto& contour : shape.contours ) {
+		numEdges += contour.edges.size();
+		double l = std::numeric_limits<double>::max();
+		double b = std::numeric_limits<double>::max();
+		double r = -std::numeric_limits<double>::max();
+		double t = -std::numeric_limits<double>::max();
+		contour.bounds( l, b, r, t );
+		if( ( r > l ) && ( t > b ) ) {
+			minFeatureSize = std::min( minFeatureSize, std::min( r - l, t - b ) );
+		}
+	}
+
+	const double minScale = static_cast<double>( format.getMinSdfScale() );
+	const double maxScale = static_cast<double>( format.getMaxSdfScale() );
+	const double complexity = std::min( std::max( ( static_cast<double>( numEdges ) - kSimpleNumEdges ) / ( kComplexNumEdges - kSimpleNumEdges ), 0.0 ), 1.0 );
+	double result = minScale + complexity * ( maxScale - minScale );
+	if( minFeatureSize < std::numeric_limits<double>::max() ) {
+		result = std::max( result, kMinFeatureTexels / minFeatureSize );
+	}
+	return static_cast<float>( std::min( std::max( result, minScale ), maxScale ) );
+}
+
+ivec2 SdfText::TextureAtlas::chooseTextureSize( const std::vector<RenderGlyph> &glyphs, bool packed, const ivec2 &tileSpacing, const SdfText::Format &format )
+{
+	ivec2 maxTextureSize = format.getMaxTextureSize();
+	const GLint maxGlTextureSize = getMaxGlTextureSize();
+	if( maxGlTextureSize > 0 ) {
+		maxTextureSize = ivec2( std::min( maxTextureSize.x, maxGlTextureSize ), std::min( maxTextureSize.y, maxGlTextureSize ) );
+	}
+	return detail::chooseTextureSize( glyphs, packed, tileSpacing, maxTextureSize, format.getTextureSize() );
+}
+
+GLint SdfText::TextureAtlas::getMaxGlTextureSize()
+{
+	// Atlases are also built on background threads, which have no GL context to ask. They use the 
+	// limit seen by the last build on the GL thread, or only Format::maxTextureSize() before that.
+	static std::atomic<GLint> sMaxGlTextureSize{ 0 };
+	if( nullptr != gl::context() ) {
+		GLint maxGlTextureSize = 0;
+		glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxGlTextureSize );
+		sMaxGlTextureSize = maxGlTextureSize;
+	}
+	return sMaxGlTextureSize;
+}
+
+SdfText::TextureAtlas::GlyphIndices SdfText::TextureAtlas::getGlyphIndices( FT_Face face, const std::string &utf8Chars, const GlyphIndices &glyphs )
+{
+	std::u32string utf32Chars = ci::toUtf32( utf8Chars );
+	// Add a space if needed
+	if( std::string::npos == utf8Chars.find( ' ' ) ) {
+		utf32Chars += ci::toUtf32( " " );
+	}
+
+	GlyphIndices result;
+	result.reserve( utf32Chars.size() + glyphs.size() );
+	FaceLock faceLock = lockFace( face );
+	for( const auto& ch : utf32Chars ) {
+		FT_UInt glyphIndex = FT_Get_Char_Index( face, static_cast<FT_ULong>( ch ) );
+		result.push_back( static_cast<SdfText::Font::Glyph>( glyphIndex ) );
+	}
+	// Glyphs without a character, e.g. ligatures and alternates picked by a shaper
+	const SdfText::Font::Glyph numGlyphs = static_cast<SdfText::Font::Glyph>( std::max<FT_Long>( face->num_glyphs, 0 ) );
+	for( const auto& glyph : glyphs ) {
+		if( glyph < numGlyphs ) {
+			result.push_back( glyph );
+		}
+	}
+	std::sort( std::begin( result ), std::end( result ) );
+	result.erase( std::unique( std::begin( result ), std::end( result ) ), std::end( result ) );
+	return result;
+}
+
+size_t SdfText::TextureAtlas::getGpuBytes() const
+{
+	size_t result = 0;
+	for( const auto& tex : mTextures ) {
+		result += static_cast<size_t>( tex->getWidth() ) * static_cast<size_t>( tex->getHeight() ) * 3;
+	}
+	// Staged pages are counted ahead of their upload, unless their layers are allocated already
+	size_t numStagedPages = mPendingPages.size();
+#if ! defined( CINDER_GL_ES_2 )
+	if( mTextureArray ) {
+		result += static_cast<size_t>( mTextureArray->getWidth() ) * static_cast<size_t>( mTextureArray->getHeight() ) * static_cast<size_t>( mTextureArray->getDepth() ) * 3;
+		numStagedPages = 0;
+	}
+#endif
+	result += numStagedPages * static_cast<size_t>( mTextureSize.x ) * static_cast<size_t>( mTextureSize.y ) * 3;
+	return result;
+}
+
+size_t SdfText::TextureAtlas::getCpuBytes() const
+{
+	size_t result = 0;
+	for( const auto& page : mCompressedPages ) {
+		result += page.mData.size();
+	}
+	return result;
+}
+
+static const uint32_t kAtlasFileMagic = 0x41464453; // "SDFA"
+static const uint32_t kAtlasFileVersion = 5;
+
+//! Returns the key of \a face without its glyphs
+static AtlasCacheKey::FaceKey createFaceKey( FT_Face face )
+{
+	AtlasCacheKey::FaceKey result;
+	result.mFamilyName = std::string( face->family_name );
+	result.mStyleName = std::string( face->style_name );
+	result.mNumGlyphs = static_cast<uint32_t>( face->num_glyphs );
+	result.mUnitsPerEm = static_cast<uint32_t>( face->units_per_EM );
+	result.mBBoxMin = ivec2( face->bbox.xMin, face->bbox.yMin );
+	result.mBBoxMax = ivec2( face->bbox.xMax, face->bbox.yMax );
+	return result;
+}
+
+bool SdfText::TextureAtlas::save( const fs::path &path, const CacheKey &key ) const
+{
+	if( mCompressedPages.size() != mNumPages ) {
+		return false;
+	}
+
+	std::ofstream os( path.string(), std::ios::binary | std::ios::trunc );
+	if( ! os.is_open() ) {
+		return false;
+	}
+
+	writeBinary( os, kAtlasFileMagic );
+	writeBinary( os, kAtlasFileVersion );
+	key.write( os );
+
+	writeBinary( os, mTextureSize );
+	writeBinary( os, mSdfBitmapSize );
+	writeBinary( os, mMaxGlyphSize );
+	writeBinary( os, mMaxAscent );
+	writeBinary( os, mMaxDescent );
+
+	writeBinary( os, static_cast<uint32_t>( mGlyphInfo.size() ) );
+	for( const auto& it : mGlyphInfo ) {
+		writeBinary( os, it.first );
+		writeBinary( os, it.second.mTextureIndex );
+		writeBinary( os, it.second.mTexCoords.x1 );
+		writeBinary( os, it.second.mTexCoords.y1 );
+		writeBinary( os, it.second.mTexCoords.x2 );
+		writeBinary( os, it.second.mTexCoords.y2 );
+		writeBinary( os, it.second.mOriginOffset );
+		writeBinary( os, it.second.mSdfScale );
+	}
+
+	writeBinary( os, static_cast<uint32_t>( mCompressedPages.size() ) );
+	for( const auto& page : mCompressedPages ) {
+		writeBinary( os, page.mSize );
+		writeBinary( os, static_cast<uint64_t>( page.mData.size() ) );
+		os.write( reinterpret_cast<const char *>( page.mData.data() ), page.mData.size() );
+	}
+
+	return os.good();
+}
+
+SdfText::TextureAtlasRef SdfText::TextureAtlas::load( const fs::path &path, const CacheKey &key, const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars )
+{
+	Timer timer( true );
+	std::ifstream is( path.string(), std::ios::binary );
+	if( ! is.is_open() ) {
+		return SdfText::TextureAtlasRef();
+	}
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	CacheKey fileKey;
+	if( ! ( readBinary( is, &magic ) && readBinary( is, &version ) ) || ( kAtlasFileMagic != magic ) || ( kAtlasFileVersion != version ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+	// Hashes may collide, so the file must have been written for the same key. Whether the pages 
+	// stay on the CPU isn't part of the file.
+	const bool validKey = fileKey.read( is );
+	fileKey.mKeepCompressedPages = key.mKeepCompressedPages;
+	if( ( ! validKey ) || ( fileKey != key ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+
+	SdfText::TextureAtlasRef result = SdfText::TextureAtlasRef( new SdfText::TextureAtlas( format ) );
+	for( const auto& face : faces ) {
+		result->addFace( face, utf8Chars );
+	}
+
+	uint32_t numGlyphs = 0;
+	if( ! ( readBinary( is, &result->mTextureSize ) && 
+		    readBinary( is, &result->mSdfBitmapSize ) && 
+		    readBinary( is, &result->mMaxGlyphSize ) && 
+		    readBinary( is, &result->mMaxAscent ) && 
+		    readBinary( is, &result->mMaxDescent ) &&
+		    readBinary( is, &numGlyphs ) &&
+		    hasRemainingBytes( is, static_cast<uint64_t>( numGlyphs ) * ( sizeof( GlyphKey ) + sizeof( uint32_t ) + 4 * sizeof( int32_t ) + 2 * sizeof( vec2 ) ) ) ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+	// Pages larger than the key allows, or than the GL can hold, mean the file is corrupt
+	const ivec2 textureSize = result->mTextureSize;
+	const GLint maxGlTextureSize = getMaxGlTextureSize();
+	if( ( textureSize.x <= 0 ) || ( textureSize.y <= 0 ) || ( textureSize.x > key.mTextureSize.x ) || ( textureSize.y > key.mTextureSize.y ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+	if( ( maxGlTextureSize > 0 ) && ( ( textureSize.x > maxGlTextureSize ) || ( textureSize.y > maxGlTextureSize ) ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+	for( uint32_t i = 0; i < numGlyphs; ++i ) {
+		GlyphKey glyphKey = 0;
+		GlyphInfo glyphInfo;
+		if( ! ( readBinary( is, &glyphKey ) &&
+			    readBinary( is, &glyphInfo.mTextureIndex ) &&
+			    readBinary( is, &glyphInfo.mTexCoords.x1 ) &&
+			    readBinary( is, &glyphInfo.mTexCoords.y1 ) &&
+			    readBinary( is, &glyphInfo.mTexCoords.x2 ) &&
+			    readBinary( is, &glyphInfo.mTexCoords.y2 ) &&
+			    readBinary( is, &glyphInfo.mOriginOffset ) &&
+			    readBinary( is, &glyphInfo.mSdfScale ) ) ) {
+			return SdfText::TextureAtlasRef();
+		}
+		// Glyphs of a face slot the atlas doesn't have, or outside of the page
+		const Area &texCoords = glyphInfo.mTexCoords;
+		if( ( ( glyphKey >> 32 ) >= faces.size() ) ||
+			( texCoords.x1 < 0 ) || ( texCoords.y1 < 0 ) || ( texCoords.x1 > texCoords.x2 ) || ( texCoords.y1 > texCoords.y2 ) ||
+			( texCoords.x2 > textureSize.x ) || ( texCoords.y2 > textureSize.y ) ) {
+			return SdfText::TextureAtlasRef();
+		}
+		result->mGlyphInfo[glyphKey] = glyphInfo;
+	}
+
+	uint32_t numPages = 0;
+	if( ! ( readBinary( is, &numPages ) && hasRemainingBytes( is, static_cast<uint64_t>( numPages ) * ( sizeof( ivec2 ) + sizeof( uint64_t ) ) ) ) ) {
+		return SdfText::TextureAtlasRef();
+	}
+	for( const auto& it : result->mGlyphInfo ) {
+		if( it.second.mTextureIndex >= numPages ) {
+			return SdfText::TextureAtlasRef();
+		}
+	}
+	std::vector<AtlasPageCodec::Page> pages( numPages );
+	for( auto& page : pages ) {
+		uint64_t numBytes = 0;
+		if( ! ( readBinary( is, &page.mSize ) && readBinary( is, &numBytes ) && hasRemainingBytes( is, numBytes ) ) || ( page.mSize != result->mTextureSize ) ) {
+			return SdfText::TextureAtlasRef();
+		}
+		page.mData.resize( static_cast<size_t>( numBytes ) );
+		is.read( reinterpret_cast<char *>( page.mData.data() ), page.mData.size() );
+		if( ! is.good() ) {
+			return SdfText::TextureAtlasRef();
+		}
+	}
+
+	// Decode everything before uploading so that a truncated file doesn't leave a partial atlas behind
+	std::vector<Surface8u> surfaces;
+	for( const auto& page : pages ) {
+		Surface8u surface( page.mSize.x, page.mSize.y, false );
+		if( ! AtlasPageCodec::decode( page, &surface ) ) {
+			return SdfText::TextureAtlasRef();
+		}
+		surfaces.push_back( surface );
+	}
+	for( const auto& surface : surfaces ) {
+		result->addPage( surface );
+	}
+	result->finishPages();
+
+	if( result->mKeepCompressedPages ) {
+		result->mCompressedPages = std::move( pages );
+	}
+	result->mBuildTime = timer.getSeconds();
+
+	return result;
+}
+
+// =================================================================================================
+// FontFile
+// =================================================================================================
+//! Bytes of a font file for FT_New_Memory_Face(). Files are memory mapped where possible, so only the pages 
+//! FreeType reads are loaded and they live in the page cache instead of the heap. Other sources are read.
+class FontFile {
+public:
+	~FontFile();
+
+	//! Maps the file at \a path, or reads it if it can't be mapped
+	static std::shared_ptr<FontFile>	create( const fs::path &path );
+	//! Returns \c nullptr if \a buffer is empty
+	static std::shared_ptr<FontFile>	create( const ci::BufferRef &buffer );
+
+	const uint8_t*	getData() const { return mData; }
+	size_t			getSize() const { return mSize; }
+
+private:
+	FontFile() {}
+
+	const uint8_t	*mData = nullptr;
+	size_t			mSize = 0;
+	ci::BufferRef	mBuffer;
+	void			*mMapping = nullptr;
+#if defined( CINDER_MSW )
+	HANDLE			mMappingHandle = nullptr;
+#endif
+};
+
+using FontFileRef = std::shared_ptr<FontFile>;
+
+//! FreeType face of a font file, shared by the fonts of every size and the atlases built from it. Each 
+//! font sets its size on an FT_Size of its own. The face is released along with its last user.
+class FontFace {
+public:
+	~FontFace();
+
+	//! Opens face \a faceIndex of \a file with its Unicode character map selected. Throws if there's no such face.
+	static std::shared_ptr<FontFace>	create( const FontFileRef &file, uint32_t faceIndex );
+
+	FT_Face		getFace() const { return mFace; }
+
+private:
+	FontFace() {}
+
+	FontFileRef		mFile;
+	FT_Face			mFace = nullptr;
+};
+
+using FontFaceRef = std::shared_ptr<FontFace>;
+
+FontFile::~FontFile()
+{
+#if defined( CINDER_MSW )
+	if( nullptr != mMapping ) {
+		::UnmapViewOfFile( mMapping );
+	}
+	if( nullptr != mMappingHandle ) {
+		::CloseHandle( mMappingHandle );
+	}
+#elif defined( CINDER_COCOA ) || defined( CINDER_LINUX ) || defined( CINDER_ANDROID )
+	if( nullptr != mMapping ) {
+		::munmap( mMapping, mSize );
+	}
+#endif
+}
+
+FontFileRef FontFile::create( const fs::path &path )
+{
+	FontFileRef result = FontFileRef( new FontFile() );
+#if defined( CINDER_MSW )
+	HANDLE file = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( INVALID_HANDLE_VALUE != file ) {
+		LARGE_INTEGER size = {};
+		if( ::GetFileSizeEx( file, &size ) && ( size.QuadPart > 0 ) ) {
+			result->mMappingHandle = ::CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+			if( nullptr != result->mMappingHandle ) {
+				result->mMapping = ::MapViewOfFile( result->mMappingHandle, FILE_MAP_READ, 0, 0, 0 );
+				result->mSize = static_cast<size_t>( size.QuadPart );
+			}
+		}
+		// The mapping keeps the file open
+		::CloseHandle( file );
+	}
+#elif defined( CINDER_COCOA ) || defined( CINDER_LINUX ) || defined( CINDER_ANDROID )
+	int fd = ::open( path.string().c_str(), O_RDONLY );
+	if( fd >= 0 ) {
+		struct stat info;
+		if( ( 0 == ::fstat( fd, &info ) ) && ( info.st_size > 0 ) ) {
+			void *mapping = ::mmap( nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+			if( MAP_FAILED != mapping ) {
+				result->mMapping = mapping;
+				result->mSize = static_cast<size_t>( info.st_size );
+			}
+		}
+		// The mapping keeps the file open
+		::close( fd );
+	}
+#endif
+	if( nullptr != result->mMapping ) {
+		result->mData = static_cast<const uint8_t *>( result->mMapping );
+		return result;
+	}
+
+	return FontFile::create( ci::loadFile( path )->getBuffer() );
+}
+
+FontFileRef FontFile::create( const ci::BufferRef &buffer )
+{
+	if( ( ! buffer ) || ( 0 == buffer->getSize() ) ) {
+		return FontFileRef();
+	}
+
+	FontFileRef result = FontFileRef( new FontFile() );
+	result->mBuffer = buffer;
+	result->mData = static_cast<const uint8_t *>( buffer->getData() );
+	result->mSize = buffer->getSize();
+	return result;
+}
+
+// =================================================================================================
+// SdfTextManager
+// =================================================================================================
+class SdfTextManager {
+public:
+	~SdfTextManager();
+
+	static SdfTextManager			*instance();
+
+	FT_Library						getLibrary() const { return mLibrary; }
+
+	const std::vector<std::string>&	getNames( bool forceRefresh );
+	SdfText::Font					getDefault() const;
+
+	struct FontInfo {
+		std::string 	key;
+		std::string 	name;
+		fs::path 		path;
+		//! Face within a font collection (.ttc, .otc)
+		uint32_t		faceIndex = 0;
+		FontInfo() {}
+		FontInfo( const std::string& aKey, const std::string& aName, const fs::path& aPath, uint32_t aFaceIndex = 0 ) 
+			: key( aKey ), name( aName ), path( aPath ), faceIndex( aFaceIndex ) {}
+	};
+
+	FontInfo 						getFontInfo( const std::string& fontName ) const;
+
+	SdfText::AtlasCacheStats		getAtlasCacheStats() const;
+	std::vector<SdfText::AtlasStats>	getCachedAtlasStats() const;
+	void							setAtlasCacheBudget( size_t bytes );
+	size_t							getAtlasCacheBudget() const { std::lock_guard<std::recursive_mutex> lock( mMutex ); return mAtlasCacheBudget; }
+	void							purgeUnusedAtlases();
+	void							setAtlasDiskCacheDirectory( const fs::path &directory ) { std::lock_guard<std::recursive_mutex> lock( mMutex ); mAtlasDiskCacheDirectory = directory; }
+	void							addFontDirectory( const fs::path &directory );
+	//! Returns the bytes of the font file at \a path, shared by every font of that file while any of them is alive
+	FontFileRef						getFontFile( const fs::path &path );
+	//! Returns face \a faceIndex of the font file at \a path, shared by every font of that face while any of them is alive
+	FontFaceRef						getFontFace( const fs::path &path, uint32_t faceIndex );
+	//! Returns true if \a face belongs to the library of this manager and hasn't been released
+	bool							isFaceAlive( FT_Face face ) const { std::lock_guard<std::recursive_mutex> lock( mMutex ); return mTrackedFaces.end() != mTrackedFaces.find( face ); }
+	fs::path						getAtlasDiskCacheDirectory() const { std::lock_guard<std::recursive_mutex> lock( mMutex ); return mAtlasDiskCacheDirectory; }
+	//! Runs \a task on one of the background threads, which are started with the first task. Tasks with a higher \a priority are run first.
+	void							runInBackground( const std::function<void()> &task, int priority = 0 );
+	//! Schedules the entries of \a manifest, see SdfText::prewarm()
+	std::vector<std::shared_future<SdfTextRef>>	prewarm( const std::vector<SdfText::PrewarmEntry> &manifest );
+	SdfText::PrewarmProgress		getPrewarmProgress() const;
+	//! Drops the tasks that haven't started yet and waits for the running ones
+	void							stopBackgroundTasks();
+
+private:
+	SdfTextManager();
+
+	//! Returns the tracked atlases and whether each is unused, so their stats can be gathered without the lock
+	std::vector<std::pair<SdfText::TextureAtlasRef, bool>>	getTrackedAtlases() const;
+
+	static std::atomic<SdfTextManager*>	sInstance;
+	//! Stops the background tasks and deletes the instance, see SdfText::shutdown()
+	static void						destroyInstance();
+
+	//! Guards everything below, including the library which faces are added to and removed from. Recursive 
+	//! since creating the default font looks up fonts and faces. Never taken while holding a face lock.
+	mutable std::recursive_mutex	mMutex;
+	FT_Library						mLibrary = nullptr;
+	bool							mFontsEnumerated = false;
+	std::vector<std::string>		mFontNames;
+	std::vector<FontInfo>			mFontInfos;
+	std::map<FT_Face, std::weak_ptr<FontFace>>	mTrackedFaces;
+	mutable SdfText::Font			mDefault;
+	//! Searched for fonts next to the standard directories on Linux
+	std::vector<fs::path>			mFontDirectories;
+	//! Font files in use by canonical path
+	std::unordered_map<std::string, std::weak_ptr<FontFile>>	mFontFiles;
+	//! Faces in use by canonical path and face index
+	std::map<std::pair<std::string, uint32_t>, std::weak_ptr<FontFace>>	mFontFaces;
+	//! Keys of mFontInfos
+	FontNameIndex											mFontNameIndex;
+	//! Fuzzy matches of names looked up before, FontNameIndex::npos if nothing matched
+	mutable std::unordered_map<std::string, size_t>			mFuzzyFontMatches;
+
+	SdfText::TextureAtlas::AtlasCacher		mTrackedTextureAtlases;
+	//! Atlases being built outside of the lock, threads asking for the same one wait for it instead of building it again
+	std::unordered_map<SdfText::TextureAtlas::CacheKey, std::shared_future<SdfText::TextureAtlasRef>, SdfText::TextureAtlas::CacheKey::Hasher>	mPendingTextureAtlases;
+	uint64_t						mAtlasCacheTick = 0;
+	size_t							mAtlasCacheBudget = 0;
+	//! Counted by atlas builds outside of the lock as well
+	std::atomic<size_t>				mAtlasCacheHits{ 0 };
+	std::atomic<size_t>				mAtlasCacheSubsetHits{ 0 };
+	std::atomic<size_t>				mAtlasCacheMisses{ 0 };
+	std::atomic<size_t>				mAtlasCacheDiskHits{ 0 };
+	std::atomic<size_t>				mAtlasCacheDerived{ 0 };
+	std::atomic<size_t>				mAtlasCacheEvictions{ 0 };
+	fs::path						mAtlasDiskCacheDirectory;
+
+	//! Guards the background tasks and threads, independent of mMutex which the tasks take
+	std::mutex						mTaskMutex;
+	std::condition_variable			mTaskCondition;
+	//! Ordered by descending priority, then by the order they were added
+	std::deque<std::pair<int, std::function<void()>>>	mTasks;
+	std::vector<std::thread>		mTaskThreads;
+	bool							mStopTasks = false;
+	std::atomic<size_t>				mPrewarmEntries{ 0 };
+	std::atomic<size_t>				mPrewarmFinished{ 0 };
+	std::atomic<size_t>				mPrewarmFailed{ 0 };
+
+	void							runBackgroundTasks();
+	void							acquireFontNamesAndPaths();
+	//! Builds the lookups of getFontInfo() from mFontInfos
+	void							buildFontIndex();
+	void							faceCreated( const FontFaceRef &face );
+	//! Releases \a face unless it went away with the library already
+	void							releaseFace( FT_Face face );
+
+	//! Returns an atlas containing \a utf8Chars and the glyph indices \a glyphs for all of \a faces. The faces share the atlas pages in the order given. 
+	//! A static atlas built by this call is published once it's laid out, then \a onPublished is called and the pages are generated before returning. 
+	//! Threads asking for it meanwhile get it right away, its glyphs become available page by page.
+	SdfText::TextureAtlasRef		getTextureAtlas( const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const SdfText::TextureAtlas::GlyphIndices &glyphs = SdfText::TextureAtlas::GlyphIndices(), const std::function<void()> &onPublished = std::function<void()>() );
+	//! Returns a cached atlas with the same format as \a key that contains all of its glyphs
+	SdfText::TextureAtlas::AtlasCacher::iterator	findSupersetAtlas( const SdfText::TextureAtlas::CacheKey &key );
+	//! Evicts least recently used atlases that no SdfText references until the cache fits into \a budget bytes
+	void							evictUnusedAtlases( size_t budget );
+	//! Returns the disk cache file for \a key in \a directory
+	static fs::path					getAtlasDiskCachePath( const fs::path &directory, const SdfText::TextureAtlas::CacheKey &key );
+	//! Loads the atlas for \a key from the disk cache or lays out a new one, whose pages are left to generateTextureAtlas(). Sets \a cachePath to the file 
+	//! the new atlas is written to once it's generated, if any. Called without holding the lock. The faces are only locked while outlines and character maps are read.
+	SdfText::TextureAtlasRef		loadOrCreateTextureAtlas( const SdfText::TextureAtlas::CacheKey &key, const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const SdfText::TextureAtlas::GlyphIndices &glyphs, fs::path *cachePath );
+	//! Generates the pages of a published \a atlas, writes it to \a cachePath unless it's empty and marks it complete. Called without holding the lock, the distance fields are generated without holding the faces either.
+	void							generateTextureAtlas( const SdfText::TextureAtlasRef &atlas, const SdfText::TextureAtlas::CacheKey &key, const fs::path &cachePath, const SdfText::Format &format );
+
+	friend class SdfText;
+	friend class SdfText::FontData;
+	friend class SdfText::TextureAtlas;
+	friend class FontFace;
+};
+
+// Needs the manager to get the atlases of the blocks from its cache
+bool SdfText::TextureAtlas::loadUnicodeBlock( uint32_t faceSlot, SdfText::Font::Glyph glyph )
+{
+	if( mGlyphBlocks.empty() ) {
+		mapUnicodeBlocks();
+	}
+
+	const auto& glyphBlocks = mGlyphBlocks[faceSlot];
+	auto it = glyphBlocks.find( glyph );
+	if( ( glyphBlocks.end() == it ) || ( ! mLoadedBlocks.insert( it->second ).second ) ) {
+		return false;
+	}
+
+	std::vector<FT_Face> faces;
+	for( const auto& face : mFaces ) {
+		faces.push_back( face.mFace );
+	}
+	Timer timer( true );
+	SdfText::TextureAtlasRef block = SdfTextManager::instance()->getTextureAtlas( faces, mBlockFormat, ci::toUtf8( mBlockChars[it->second] ) );
+	block->finishPages();
+	// Without a GL context the pages of the block are still staged, merging it now would leave its glyphs pointing 
+	// past mTextures. The same goes for a block another thread is still generating. Keep the block unloaded so a 
+	// later draw picks it up from the cache.
+	if( ( ! block->isComplete() ) || block->hasPendingPages() ) {
+		mLoadedBlocks.erase( it->second );
+		return false;
+	}
+	addUnicodeBlock( *block );
+	mBlockAtlases.push_back( block );
+	mBuildTime += timer.getSeconds();
+	return true;
+}
+
+// =================================================================================================
+// SdfTextBox
+// =================================================================================================
+class SdfTextBox {
+public:
+	typedef enum Alignment { LEFT, CENTER, RIGHT } Alignment;
+	enum { GROW = 0 };
+	
+	//! Takes the font up front, looking up the default font would take the manager lock while measuring holds a face lock
+	explicit SdfTextBox( const SdfText::Font &font ) : mAlign( LEFT ), mSize( GROW, GROW ), mFont( font ), mInvalid( true ), mLigate( true ) {}
+
+	SdfTextBox&				size( ivec2 sz ) { setSize( sz ); return *this; }
+	SdfTextBox&				size( int width, int height ) { setSize( ivec2( width, height ) ); return *this; }
+	ivec2					getSize() const { return mSize; }
+	void					setSize( ivec2 sz ) { mSize = sz; mInvalid = true; }
+
+	SdfTextBox&				text( const std::string &t ) { setText( t ); return *this; }
+	const std::string&		getText() const { return mText; }
+	void					setText( const std::string &t ) { mText = t; mInvalid = true; }
+	void					appendText( const std::string &t ) { mText += t; mInvalid = true; }
+
+	SdfTextBox&				font( const SdfText::Font &f ) { setFont( f ); return *this; }
+	const SdfText::Font&	getFont() const { return mFont; }
+	void					setFont( const SdfText::Font &f ) { mFont = f; mInvalid = true; }
+
+	SdfTextBox&				ligate( bool ligateText = true ) { setLigate( ligateText ); return *this; }
+	bool					getLigate() const { return mLigate; }
+	void					setLigate( bool ligateText ) { mLigate = ligateText; }
+
+	//! Breaks lines with the advances in \a cachedGlyphMetrics scaled by \a sizeScale
+	std::vector<std::string>							calculateLineBreaks( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics, float sizeScale = 1.0f ) const;
+	std::vector<std::pair<SdfText::Font::Glyph,vec2>>	measureGlyphs( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics, const SdfText::DrawOptions& drawOptions ) const;
+
+private:
+	Alignment		mAlign;
+	ivec2			mSize;
+	std::string		mText;
+	SdfText::Font	mFont;
+	bool			mLigate;
+	mutable bool	mInvalid;
+};
+
+// =================================================================================================
+// SdfTexttManager Implementation
+// =================================================================================================
+std::atomic<SdfTextManager*> SdfTextManager::sInstance( nullptr );
+
+void SdfTextManager::destroyInstance()
+{
+	SdfTextManager *fontManager = SdfTextManager::sInstance.load();
+	if( nullptr == fontManager ) {
+		return;
+	}
+
+	// Tasks still running would get a new manager once this one is gone
+	fontManager->stopBackgroundTasks();
+	// At exit the GL context is usually gone already, deleting the textures would call into GL without one. 
+	// The cached atlases are left to the OS instead, the faces and FreeType don't need a context.
+	if( nullptr == gl::context() ) {
+		std::lock_guard<std::recursive_mutex> lock( fontManager->mMutex );
+		auto leakedAtlases = new SdfText::TextureAtlas::AtlasCacher();
+		leakedAtlases->swap( fontManager->mTrackedTextureAtlases );
+	}
+	// Faces released while the manager goes away are left to its destructor
+	delete SdfTextManager::sInstance.exchange( nullptr );
+}
+
+SdfTextManager::SdfTextManager()
+{
+	FT_Error ftRes = FT_Init_FreeType( &mLibrary );
+	if( FT_Err_Ok != ftRes ) {
+		throw FontInvalidNameExc("Failed to initialize FreeType2");
+	}
+
+	acquireFontNamesAndPaths();
+#if defined( CINDER_MSW )
+	// Registry operations can be rejected by Windows so no fonts will be picked up 
+	// on the initial scan. So we can multiple times.
+	if( mFontInfos.empty() ) {
+		for( int i = 0; i < 5; ++i ) {
+			acquireFontNamesAndPaths();
+			if( ! mFontInfos.empty() ) {
+				break;
+			}
+			::Sleep( 10 );
+		}
+	}
+#endif
+	buildFontIndex();
+}
+
+SdfTextManager::~SdfTextManager()
+{
+	stopBackgroundTasks();
+
+	if( nullptr != mLibrary ) {
+		// Cached atlases hold on to their faces
+		mTrackedTextureAtlases.clear();
+		// Faces still in use go away with the library, see releaseFace()
+		for( auto& it : mTrackedFaces ) {
+			FT_Done_Face( it.first );
+		}
+		mTrackedFaces.clear();
+
+		FT_Done_FreeType( mLibrary );
+	}
+
+#if defined( CINDER_MAC )
+//	[nsFontManager release];
+#elif defined( CINDER_WINRT )
+#elif defined( CINDER_ANDROID ) || defined( CINDER_LINUX )
+#endif
+}
+
+SdfTextManager* SdfTextManager::instance()
+{
+	SdfTextManager *result = SdfTextManager::sInstance.load();
+	if( nullptr == result ) {
+		static std::mutex sInstanceMutex;
+		std::lock_guard<std::mutex> lock( sInstanceMutex );
+		result = SdfTextManager::sInstance.load();
+		if( nullptr == result ) {
+			result = new SdfTextManager();
+			SdfTextManager::sInstance.store( result );
+			// Released at exit unless SdfText::shutdown() did so before, the manager may be created again after that
+			static bool sAtExitRegistered = false;
+			if( ! sAtExitRegistered ) {
+				std::atexit( []() { SdfTextManager::destroyInstance(); } );
+				sAtExitRegistered = true;
+			}
+		}
+	}
+	
+	return result;
+}
+
+void SdfTextManager::runInBackground( const std::function<void()> &task, int priority )
+{
+	std::lock_guard<std::mutex> lock( mTaskMutex );
+	if( mStopTasks ) {
+		return;
+	}
+
+	auto it = std::upper_bound( std::begin( mTasks ), std::end( mTasks ), priority, 
+		[]( int value, const std::pair<int, std::function<void()>> &queued ) -> bool {
+			return value > queued.first;
+		}
+	);
+	mTasks.insert( it, std::make_pair( priority, task ) );
+	// Leave a core to the GL thread
+	const size_t numThreads = std::max<size_t>( std::thread::hardware_concurrency(), 2 ) - 1;
+	if( mTaskThreads.size() < numThreads ) {
+		mTaskThreads.push_back( std::thread( &SdfTextManager::runBackgroundTasks, this ) );
+	}
+	mTaskCondition.notify_one();
+}
+
+void SdfTextManager::stopBackgroundTasks()
+{
+	std::vector<std::thread> threads;
+	{
+		std::lock_guard<std::mutex> lock( mTaskMutex );
+		mStopTasks = true;
+		mTasks.clear();
+		threads.swap( mTaskThreads );
+	}
+	mTaskCondition.notify_all();
+
+	for( auto& thread : threads ) {
+		thread.join();
+	}
+}
+
+void SdfTextManager::runBackgroundTasks()
+{
+	for( ;; ) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock( mTaskMutex );
+			mTaskCondition.wait( lock, [this]() { return mStopTasks || ( ! mTasks.empty() ); } );
+			if( mStopTasks ) {
+				return;
+			}
+			task = std::move( mTasks.front().second );
+			mTasks.pop_front();
+		}
+
+		try {
+			task();
+		}
+		catch( const std::exception &e ) {
+			CI_LOG_E( "Background task failed: " << e.what() );
+		}
+	}
+}
+
+std::vector<std::shared_future<SdfTextRef>> SdfTextManager::prewarm( const std::vector<SdfText::PrewarmEntry> &manifest )
+{
+	std::vector<std::shared_future<SdfTextRef>> result;
+	mPrewarmEntries += manifest.size();
+	for( const auto& entry : manifest ) {
+		auto task = std::make_shared<std::packaged_task<SdfTextRef()>>( [this, entry]() -> SdfTextRef {
+			try {
+				// Entries by name load their faces here as well
+				SdfText::Font font = entry.font ? entry.font : SdfText::Font( entry.fontName, entry.fontSize );
+				SdfTextRef sdfText = SdfTextRef( new SdfText( font, entry.format, entry.utf8Chars, entry.glyphs ) );
+				++mPrewarmFinished;
+				return sdfText;
+			}
+			catch( const std::exception &e ) {
+				CI_LOG_W( "Failed to prewarm " << ( entry.font ? entry.font.getName() : entry.fontName ) << ": " << e.what() );
+				++mPrewarmFailed;
+				++mPrewarmFinished;
+				throw;
+			}
+		} );
+		result.push_back( task->get_future().share() );
+		runInBackground( [task]() { ( *task )(); }, entry.priority );
+	}
+	return result;
+}
+
+SdfText::PrewarmProgress SdfTextManager::getPrewarmProgress() const
+{
+	SdfText::PrewarmProgress result;
+	result.numEntries = mPrewarmEntries;
+	result.numFinished = mPrewarmFinished;
+	result.numFailed = mPrewarmFailed;
+	return result;
+}
+
+//! Different spellings of the same path share the file, and the directory when walking font directories
+static std::string getFontFileKey( const fs::path &path )
+{
+	try {
+		return fs::canonical( path ).string();
+	}
+	catch( const std::exception & ) {
+	}
+	return path.string();
+}
+
+#if defined( CINDER_MAC )
+void SdfTextManager::acquireFontNamesAndPaths()
+{
+}
+#elif defined( CINDER_MSW )
+void SdfTextManager::acquireFontNamesAndPaths()
+{
+	static const LPWSTR kFontRegistryPath = L"Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
+
+	// Open Windows font registry key
+	HKEY hKey = nullptr;
+	LONG result = RegOpenKeyEx( HKEY_LOCAL_MACHINE, kFontRegistryPath, 0, KEY_READ, &hKey );
+	if( ERROR_SUCCESS != result ) {
+		return;
+	}
+	
+	// Get info for registry key
+	DWORD maxValueNameSize, maxValueDataSize;
+	result = RegQueryInfoKey( hKey, 0, 0, 0, 0, 0, 0, 0, &maxValueNameSize, &maxValueDataSize, 0, 0 );
+	if( ERROR_SUCCESS != result ) {
+		return;
+	}
+
+	DWORD valueIndex = 0;
+	LPWSTR valueName = new WCHAR[maxValueNameSize];
+	LPBYTE valueData = new BYTE[maxValueDataSize];
+	DWORD valueNameSize, valueDataSize, valueType;
+
+	// Enumerate registry keys
+	do {
+		valueNameSize = maxValueNameSize;
+		valueDataSize = maxValueDataSize;
+
+		// Clear the buffers
+		std::memset( valueName, 0, maxValueNameSize*sizeof( WCHAR ) );
+		std::memset( valueData, 0, maxValueDataSize*sizeof( BYTE ) );
+
+		// Read registry key values
+		result = RegEnumValue( hKey, valueIndex, valueName, &valueNameSize, 0, &valueType, valueData, &valueDataSize );
+		++valueIndex;
+
+		// Bail if read fails
+		if( ( ERROR_SUCCESS != result ) || ( REG_SZ != valueType ) ) {
+			continue;
+		}
+
+		// Build font info
+		const std::string kTrueTypeTag = "(TrueType)";
+		// Font name
+		std::wstring wsFontName = std::wstring( valueName, valueNameSize );
+		std::string fontName = ci::toUtf8( reinterpret_cast<const char16_t *>( wsFontName.c_str() ), wsFontName.length() * sizeof( char16_t ) );
+		// Font file path
+		//std::wstring wsFontFilePath = std::wstring( reinterpret_cast<LPWSTR>( valueData ), valueDataSize );
+		std::wstring wsFontFilePath;
+		for( size_t i = 0; i < valueDataSize; ++i ) {
+			WCHAR ch = reinterpret_cast<LPWSTR>( valueData )[i];
+			if( 0 == ch ) {
+				break;
+			}
+			wsFontFilePath.push_back( ch );		
+		}
+		std::string fontFilePath = ci::toUtf8( reinterpret_cast<const char16_t *>( wsFontFilePath.c_str() ), wsFontFilePath.length() * sizeof( char16_t ) );
+		// Process True Type font
+		if( std::string::npos != fontName.find( kTrueTypeTag ) ) {
+			boost::replace_all( fontName, kTrueTypeTag, "" );
+			boost::trim( fontName );
+			std::string fontKey = boost::to_lower_copy( fontName );
+			auto it = std::find_if( std::begin( mFontInfos ), std::end( mFontInfos ),
+				[fontKey]( const FontInfo& elem ) -> bool {
+					return elem.key == fontKey;
+				}
+			);
+			if( std::end( mFontInfos ) == it ) {
+				fontFilePath = "C:\\Windows\\Fonts\\" + fontFilePath;
+				if( fs::exists( fontFilePath ) ) {
+					// Build font info
+					FontInfo fontInfo = FontInfo( fontKey, fontName, fontFilePath );
+					mFontInfos.push_back( fontInfo );
+					mFontNames.push_back( fontName );
 
-	static SdfTextManager			*sInstance;
+					/*
+					FT_Face face = nullptr;
+					FT_Error ftErr = FT_New_Face( mLibrary, fontFilePath.c_str(), 0, &face );
+					if( FT_Err_Ok == ftErr ) {
+						std::string styleName = face->style_name;
+						boost::trim( styleName );
+						std::string styleKey = boost::to_lower_copy( styleName );
+						if( "regular" != styleKey ) {
+							fontKey = fontKey + " " + styleKey;
+							fontName = fontName + " " + styleName;
+						}
+						// Build font info
+						FontInfo fontInfo = FontInfo( fontKey, fontName, fontFilePath );
+						mFontInfos.push_back( fontInfo );
+						mFontNames.push_back( fontName );
+						// Destroy face
+						FT_Done_Face( face );
+					}
+					*/
+				}
+			}
+		}
+	} 
+	while( ERROR_NO_MORE_ITEMS != result  );
 
-	FT_Library						mLibrary = nullptr;
-	bool							mFontsEnumerated = false;
-	std::vector<std::string>		mFontNames;
-	std::vector<FontInfo>			mFontInfos;
-	std::set<FT_Face>				mTrackedFaces;
-	mutable SdfText::Font			mDefault;
+	delete [] valueName;
+	delete [] valueData;
+}
+#elif defined( CINDER_WINRT ) 
+void SdfTextManager::acquireFontNamesAndPaths()
+{
+}
+#elif defined( CINDER_ANDROID )
+void SdfTextManager::acquireFontNamesAndPaths()
+{
+	fs::path systemFontDir = "/system/fonts";
+	if( fs::exists( systemFontDir ) && fs::is_directory( systemFontDir ) ) {
+		fs::directory_iterator end_iter;
+		for( fs::directory_iterator dir_iter( systemFontDir ) ; dir_iter != end_iter ; ++dir_iter ) {
+			if( fs::is_regular_file( dir_iter->status() ) ) {
+				fs::path fontPath = dir_iter->path();
 
-	SdfText::TextureAtlas::AtlasCacher		mTrackedTextureAtlases;
+				FT_Face tmpFace;
+				FT_Error error = FT_New_Face( mLibrary, fontPath.string().c_str(), 0, &tmpFace );
+				if( error ) {
+					continue;
+				}
 
-	void							acquireFontNamesAndPaths();
-	void							faceCreated( FT_Face face );
-	void							faceDestroyed( FT_Face face );
+				std::string fontName = ci::linux::ftutil::GetFontName( tmpFace, fontPath.stem().string() );
+				std::string keyName = fontName;
+				std::transform( keyName.begin(), keyName.end(), keyName.begin(), [](char c) -> char { return (c >= 'A' && c <='Z') ? (c + 32) : c; } );
+				mFontInfos.push_back( FontInfo( keyName, fontName, fontPath ) );
+
+				const std::string regular = "regular";
+				size_t startPos = keyName.find( regular );
+				if( std::string::npos != startPos ) {
+					keyName.replace( startPos, regular.length(), "" );
+					mFontInfos.push_back( FontInfo( keyName, fontName, fontPath ) );
+				} 	
 
-	SdfText::TextureAtlasRef		getTextureAtlas( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars );
+				FT_Done_Face( tmpFace );
+			}
+		}
+	}
+}
+#elif defined( CINDER_LINUX )
+static const uint32_t kFontIndexMagic = 0x49464453; // "SDFI"
+static const uint32_t kFontIndexVersion = 1;
 
-	friend class SdfText;
-	friend class SdfText::FontData;
-	friend bool SdfTextFontManager_destroyStaticInstance();
+//! Fonts of a directory along with its modification time, which changes whenever a file or subdirectory is added, removed or renamed
+struct FontIndexDirectory {
+	int64_t									mModified = 0;
+	std::vector<SdfTextManager::FontInfo>	mFonts;
 };
 
-// =================================================================================================
-// SdfTextBox
-// =================================================================================================
-class SdfTextBox {
-public:
-	typedef enum Alignment { LEFT, CENTER, RIGHT } Alignment;
-	enum { GROW = 0 };
-	
-	SdfTextBox() : mAlign( LEFT ), mSize( GROW, GROW ), mFont( SdfText::Font::getDefault() ), mInvalid( true ), mLigate( true ) {}
+using FontIndex = std::map<std::string, FontIndexDirectory>;
 
-	SdfTextBox&				size( ivec2 sz ) { setSize( sz ); return *this; }
-	SdfTextBox&				size( int width, int height ) { setSize( ivec2( width, height ) ); return *this; }
-	ivec2					getSize() const { return mSize; }
-	void					setSize( ivec2 sz ) { mSize = sz; mInvalid = true; }
+static fs::path getFontIndexPath()
+{
+	const char *cacheHome = std::getenv( "XDG_CACHE_HOME" );
+	const fs::path cacheDir = ( ( nullptr != cacheHome ) && ( 0 != cacheHome[0] ) ) ? fs::path( cacheHome ) : ( ci::getHomeDirectory() / ".cache" );
+	return cacheDir / "cinder" / "sdftext_fonts.idx";
+}
 
-	SdfTextBox&				text( const std::string &t ) { setText( t ); return *this; }
-	const std::string&		getText() const { return mText; }
-	void					setText( const std::string &t ) { mText = t; mInvalid = true; }
-	void					appendText( const std::string &t ) { mText += t; mInvalid = true; }
+static std::vector<fs::path> getStandardFontDirectories()
+{
+	std::vector<fs::path> result = { "/usr/share/fonts", "/usr/local/share/fonts" };
+	const char *dataHome = std::getenv( "XDG_DATA_HOME" );
+	const fs::path dataDir = ( ( nullptr != dataHome ) && ( 0 != dataHome[0] ) ) ? fs::path( dataHome ) : ( ci::getHomeDirectory() / ".local" / "share" );
+	result.push_back( dataDir / "fonts" );
+	result.push_back( ci::getHomeDirectory() / ".fonts" );
+	return result;
+}
 
-	SdfTextBox&				font( const SdfText::Font &f ) { setFont( f ); return *this; }
-	const SdfText::Font&	getFont() const { return mFont; }
-	void					setFont( const SdfText::Font &f ) { mFont = f; mInvalid = true; }
+//! Returns the modification time of \a path in nanoseconds, or -1 if it can't be read
+static int64_t getModifiedTime( const fs::path &path )
+{
+	struct stat info;
+	if( 0 != ::stat( path.string().c_str(), &info ) ) {
+		return -1;
+	}
+	return static_cast<int64_t>( info.st_mtim.tv_sec ) * 1000000000 + static_cast<int64_t>( info.st_mtim.tv_nsec );
+}
 
-	SdfTextBox&				ligate( bool ligateText = true ) { setLigate( ligateText ); return *this; }
-	bool					getLigate() const { return mLigate; }
-	void					setLigate( bool ligateText ) { mLigate = ligateText; }
+static bool isFontFile( const fs::path &path )
+{
+	const std::string ext = boost::to_lower_copy( path.extension().string() );
+	return ( ".ttf" == ext ) || ( ".otf" == ext ) || ( ".ttc" == ext ) || ( ".otc" == ext );
+}
 
-	std::vector<std::string>							calculateLineBreaks( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics ) const;
-	std::vector<std::pair<SdfText::Font::Glyph,vec2>>	measureGlyphs( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics, const SdfText::DrawOptions& drawOptions ) const;
+//! Returns the fonts of every face in the font file \a path, named by family and style like "DejaVu Sans Bold"
+static std::vector<SdfTextManager::FontInfo> probeFontFile( FT_Library library, const fs::path &path )
+{
+	std::vector<SdfTextManager::FontInfo> result;
+	FT_Long numFaces = 1;
+	for( FT_Long faceIndex = 0; faceIndex < numFaces; ++faceIndex ) {
+		FT_Face face = nullptr;
+		if( FT_Err_Ok != FT_New_Face( library, path.string().c_str(), faceIndex, &face ) ) {
+			break;
+		}
+		numFaces = face->num_faces;
+		std::string familyName = ( nullptr != face->family_name ) ? face->family_name : path.stem().string();
+		std::string styleName = ( nullptr != face->style_name ) ? face->style_name : "";
+		FT_Done_Face( face );
+
+		boost::trim( familyName );
+		boost::trim( styleName );
+		const bool regular = styleName.empty() || ( "regular" == boost::to_lower_copy( styleName ) );
+		const std::string fontName = regular ? familyName : ( familyName + " " + styleName );
+		result.push_back( SdfTextManager::FontInfo( boost::to_lower_copy( fontName ), fontName, path, static_cast<uint32_t>( faceIndex ) ) );
+		// Regular faces are found with and without their style, same as on Android
+		if( regular && ( ! styleName.empty() ) ) {
+			result.push_back( SdfTextManager::FontInfo( boost::to_lower_copy( familyName + " " + styleName ), fontName, path, static_cast<uint32_t>( faceIndex ) ) );
+		}
+	}
+	return result;
+}
 
-private:
-	Alignment		mAlign;
-	ivec2			mSize;
-	std::string		mText;
-	SdfText::Font	mFont;
-	bool			mLigate;
-	mutable bool	mInvalid;
-};
+static bool readFontIndex( const fs::path &path, FontIndex *index )
+{
+	std::ifstream is( path.string(), std::ios::binary );
+	if( ! is ) {
+		return false;
+	}
 
-// =================================================================================================
-// SdfTexttManager Implementation
-// =================================================================================================
-SdfTextManager* SdfTextManager::sInstance = nullptr;
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t numDirectories = 0;
+	if( ! ( readBinary( is, &magic ) && readBinary( is, &version ) && readBinary( is, &numDirectories ) ) || ( kFontIndexMagic != magic ) || ( kFontIndexVersion != version ) ) {
+		return false;
+	}
 
-bool SdfTextFontManager_destroyStaticInstance() 
-{
-	if( nullptr != SdfTextManager::sInstance ) {
-		delete SdfTextManager::sInstance;
-		SdfTextManager::sInstance = nullptr;
+	for( uint32_t i = 0; i < numDirectories; ++i ) {
+		std::string directory;
+		FontIndexDirectory entry;
+		uint32_t numFonts = 0;
+		if( ! ( readBinaryString( is, &directory ) && readBinary( is, &entry.mModified ) && readBinary( is, &numFonts ) ) ) {
+			return false;
+		}
+		for( uint32_t j = 0; j < numFonts; ++j ) {
+			SdfTextManager::FontInfo fontInfo;
+			std::string fontPath;
+			if( ! ( readBinaryString( is, &fontInfo.key ) && readBinaryString( is, &fontInfo.name ) && readBinaryString( is, &fontPath ) && readBinary( is, &fontInfo.faceIndex ) ) ) {
+				return false;
+			}
+			fontInfo.path = fontPath;
+			entry.mFonts.push_back( fontInfo );
+		}
+		( *index )[directory] = std::move( entry );
 	}
 	return true;
 }
 
-SdfTextManager::SdfTextManager()
+static bool writeFontIndex( const fs::path &path, const FontIndex &index )
 {
-	FT_Error ftRes = FT_Init_FreeType( &mLibrary );
-	if( FT_Err_Ok != ftRes ) {
-		throw FontInvalidNameExc("Failed to initialize FreeType2");
+	std::ofstream os( path.string(), std::ios::binary );
+	if( ! os ) {
+		return false;
 	}
 
-	acquireFontNamesAndPaths();
-#if defined( CINDER_MSW )
-	// Registry operations can be rejected by Windows so no fonts will be picked up 
-	// on the initial scan. So we can multiple times.
-	if( mFontInfos.empty() ) {
-		for( int i = 0; i < 5; ++i ) {
-			acquireFontNamesAndPaths();
-			if( ! mFontInfos.empty() ) {
-				break;
+	writeBinary( os, kFontIndexMagic );
+	writeBinary( os, kFontIndexVersion );
+	writeBinary( os, static_cast<uint32_t>( index.size() ) );
+	for( const auto& it : index ) {
+		writeBinaryString( os, it.first );
+		writeBinary( os, it.second.mModified );
+		writeBinary( os, static_cast<uint32_t>( it.second.mFonts.size() ) );
+		for( const auto& fontInfo : it.second.mFonts ) {
+			writeBinaryString( os, fontInfo.key );
+			writeBinaryString( os, fontInfo.name );
+			writeBinaryString( os, fontInfo.path.string() );
+			writeBinary( os, fontInfo.faceIndex );
+		}
+	}
+	return os.good();
+}
+
+void SdfTextManager::acquireFontNamesAndPaths()
+{
+	const fs::path indexPath = getFontIndexPath();
+	FontIndex cachedIndex;
+	readFontIndex( indexPath, &cachedIndex );
+	// An unchanged directory still has the subdirectories it had when it was indexed
+	std::multimap<std::string, std::string> cachedSubdirectories;
+	for( const auto& it : cachedIndex ) {
+		cachedSubdirectories.insert( std::make_pair( fs::path( it.first ).parent_path().string(), it.first ) );
+	}
+
+	// Walk the directories, only the files of changed ones are listed and probed
+	FontIndex index;
+	std::vector<std::pair<std::string, fs::path>> filesToProbe;
+	std::vector<fs::path> directories = getStandardFontDirectories();
+	directories.insert( std::end( directories ), std::begin( mFontDirectories ), std::end( mFontDirectories ) );
+	bool changed = false;
+	// Symlinked directories are followed, but each real directory only once so that links back up the tree don't loop
+	std::unordered_set<std::string> visitedDirectories;
+	while( ! directories.empty() ) {
+		const fs::path directory = directories.back();
+		directories.pop_back();
+		const std::string directoryKey = directory.string();
+		const int64_t modified = getModifiedTime( directory );
+		if( ( modified < 0 ) || ( index.end() != index.find( directoryKey ) ) ) {
+			continue;
+		}
+		if( ! visitedDirectories.insert( getFontFileKey( directory ) ).second ) {
+			continue;
+		}
+
+		FontIndexDirectory& entry = index[directoryKey];
+		entry.mModified = modified;
+		auto cachedIt = cachedIndex.find( directoryKey );
+		if( ( cachedIndex.end() != cachedIt ) && ( cachedIt->second.mModified == modified ) ) {
+			entry.mFonts = cachedIt->second.mFonts;
+			auto range = cachedSubdirectories.equal_range( directoryKey );
+			for( auto it = range.first; it != range.second; ++it ) {
+				directories.push_back( it->second );
+			}
+			continue;
+		}
+
+		changed = true;
+		try {
+			for( fs::directory_iterator it( directory ), end; it != end; ++it ) {
+				if( fs::is_directory( it->status() ) ) {
+					directories.push_back( it->path() );
+				}
+				else if( isFontFile( it->path() ) ) {
+					filesToProbe.push_back( std::make_pair( directoryKey, it->path() ) );
+				}
+			}
+		}
+		catch( const std::exception &exc ) {
+			CI_LOG_W( "Failed to list font directory " << directory << ": " << exc.what() );
+		}
+	}
+	// Directories that are gone
+	changed = changed || ( index.size() != cachedIndex.size() );
+
+	// Opening faces is the slow part, so files are spread over worker threads. A FreeType 
+	// library can't be used by several threads at once, each worker opens its own.
+	std::vector<std::vector<FontInfo>> probedFonts( filesToProbe.size() );
+	std::atomic<size_t> nextFile( 0 );
+	auto probeFiles = [&]() {
+		FT_Library library = nullptr;
+		if( FT_Err_Ok != FT_Init_FreeType( &library ) ) {
+			return;
+		}
+		for( size_t i = nextFile++; i < filesToProbe.size(); i = nextFile++ ) {
+			probedFonts[i] = probeFontFile( library, filesToProbe[i].second );
+		}
+		FT_Done_FreeType( library );
+	};
+	const size_t numWorkers = std::min<size_t>( std::max<size_t>( std::thread::hardware_concurrency(), 1 ), filesToProbe.size() );
+	std::vector<std::thread> workers;
+	for( size_t i = 1; i < numWorkers; ++i ) {
+		workers.push_back( std::thread( probeFiles ) );
+	}
+	if( numWorkers > 0 ) {
+		probeFiles();
+	}
+	for( auto& worker : workers ) {
+		worker.join();
+	}
+	for( size_t i = 0; i < filesToProbe.size(); ++i ) {
+		auto& fonts = index[filesToProbe[i].first].mFonts;
+		fonts.insert( std::end( fonts ), std::begin( probedFonts[i] ), std::end( probedFonts[i] ) );
+	}
+
+	// Directories are sorted by path, so the same fonts win name clashes on every run
+	std::set<std::string> uniqueNames;
+	for( const auto& it : index ) {
+		for( const auto& fontInfo : it.second.mFonts ) {
+			mFontInfos.push_back( fontInfo );
+			if( uniqueNames.insert( fontInfo.name ).second ) {
+				mFontNames.push_back( fontInfo.name );
 			}
-			::Sleep( 10 );
 		}
 	}
+
+	if( changed ) {
+		try {
+			fs::create_directories( indexPath.parent_path() );
+		}
+		catch( const std::exception & ) {
+		}
+		if( ! writeFontIndex( indexPath, index ) ) {
+			CI_LOG_W( "Failed to write font index: " << indexPath );
+		}
+	}
+}
 #endif
+
+void SdfTextManager::addFontDirectory( const fs::path &directory )
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	mFontDirectories.push_back( directory );
+	getNames( true );
 }
 
-SdfTextManager::~SdfTextManager()
+FontFileRef SdfTextManager::getFontFile( const fs::path &path )
 {
-	if( nullptr != mLibrary ) {
-		for( auto& face : mTrackedFaces ) {
-			FT_Done_Face( face );
+	const std::string key = getFontFileKey( path );
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	FontFileRef result = mFontFiles[key].lock();
+	if( ! result ) {
+		for( auto it = mFontFiles.begin(); it != mFontFiles.end(); ) {
+			it = it->second.expired() ? mFontFiles.erase( it ) : std::next( it );
 		}
+		result = FontFile::create( path );
+		mFontFiles[key] = result;
+	}
+	return result;
+}
 
-		FT_Done_FreeType( mLibrary );
+FontFaceRef SdfTextManager::getFontFace( const fs::path &path, uint32_t faceIndex )
+{
+	const auto key = std::make_pair( getFontFileKey( path ), faceIndex );
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	FontFaceRef result = mFontFaces[key].lock();
+	if( ! result ) {
+		for( auto it = mFontFaces.begin(); it != mFontFaces.end(); ) {
+			it = it->second.expired() ? mFontFaces.erase( it ) : std::next( it );
+		}
+		result = FontFace::create( getFontFile( path ), faceIndex );
+		mFontFaces[key] = result;
+	}
+	return result;
+}
+
+void SdfTextManager::faceCreated( const FontFaceRef &face ) 
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	mTrackedFaces[face->getFace()] = face;
+}
+
+void SdfTextManager::releaseFace( FT_Face face ) 
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	if( mTrackedFaces.erase( face ) > 0 ) {
+		FT_Done_Face( face );
+	}
+}
+
+SdfText::TextureAtlasRef SdfTextManager::getTextureAtlas( const std::vector<FT_Face> &faces, const SdfText::Format &requestedFormat, const std::string &utf8Chars, const SdfText::TextureAtlas::GlyphIndices &glyphs, const std::function<void()> &onPublished )
+{
+	// Below Format::pyramidSdfScale() the atlas is derived from the one at that scale, which keeps its 
+	// compressed pages to derive from. Adaptive and dynamic atlases have no uniform scale to derive.
+	const vec2& pyramidSdfScale = requestedFormat.getPyramidSdfScale();
+	const vec2& sdfScale = requestedFormat.getSdfScale();
+	// Unicode block atlases pass the pyramid on to the atlases of their blocks.
+	const bool unicodeBlocks = requestedFormat.getUnicodeBlocks() && ( ! requestedFormat.getDynamic() );
+	const bool pyramid = ( ! requestedFormat.getDynamic() ) && ( ! unicodeBlocks ) && ( ! requestedFormat.getAdaptiveSdfScale() ) && 
+						 ( pyramidSdfScale.x > 0.0f ) && ( pyramidSdfScale.y > 0.0f ) &&
+						 ( pyramidSdfScale.x >= sdfScale.x ) && ( pyramidSdfScale.y >= sdfScale.y );
+	const bool derived = pyramid && ( pyramidSdfScale != sdfScale );
+	SdfText::Format format = requestedFormat;
+	format.unicodeBlocks( unicodeBlocks );
+	if( unicodeBlocks ) {
+		format.textureArray( false ).autoTextureSize( false );
+	}
+	else {
+		format.pyramidSdfScale( 0.0f );
+	}
+	if( pyramid && ( ! derived ) ) {
+		format.keepCompressedPages();
+	}
+
+	SdfText::TextureAtlas::CacheKey key;
+
+	// Only character map lookups, the outlines are loaded when the atlas is built
+	for( const auto& face : faces ) {
+		AtlasCacheKey::FaceKey faceKey = createFaceKey( face );
+		// Canonical glyph set, independent of character order and duplicates. Dynamic and Unicode block 
+		// atlases start out empty, so they're shared by everyone using the same faces and format.
+		if( ( ! format.getDynamic() ) && ( ! unicodeBlocks ) ) {
+			faceKey.mGlyphIndices = SdfText::TextureAtlas::getGlyphIndices( face, utf8Chars, glyphs );
+		}
+		key.mFaces.push_back( faceKey );
+	}
+	
+	// Only static atlases know their glyphs up front to pick a page size for
+	key.mAutoTextureSize = format.getAutoTextureSize() && ( ! format.getDynamic() );
+	key.mTextureSize = key.mAutoTextureSize ? format.getMaxTextureSize() : format.getTextureSize();
+	key.mSdfScale = format.getSdfScale();
+	key.mSdfPadding = format.getSdfPadding();
+	key.mSdfRange = format.getSdfRange();
+	key.mSdfAngle = format.getSdfAngle();
+	key.mSdfTileSpacing = format.getSdfTileSpacing();
+	key.mTextureArray = format.getTextureArray();
+	key.mKeepCompressedPages = format.getKeepCompressedPages();
+	key.mAdaptiveSdfScale = format.getAdaptiveSdfScale();
+	key.mSdfScaleRange = format.getAdaptiveSdfScale() ? vec2( format.getMinSdfScale(), format.getMaxSdfScale() ) : vec2( 0 );
+	key.mDynamic = format.getDynamic();
+	key.mMaxPages = format.getDynamic() ? format.getMaxPages() : 0;
+	key.mPyramidSdfScale = ( derived || unicodeBlocks ) ? format.getPyramidSdfScale() : vec2( 0 );
+	key.mUnicodeBlocks = unicodeBlocks;
+
+	std::unique_lock<std::recursive_mutex> lock( mMutex );
+	// Wait for another thread that's building the same atlas
+	auto pendingIt = mPendingTextureAtlases.find( key );
+	if( mPendingTextureAtlases.end() != pendingIt ) {
+		std::shared_future<SdfText::TextureAtlasRef> pending = pendingIt->second;
+		++mAtlasCacheHits;
+		lock.unlock();
+		return pending.get();
+	}
+
+	// Result
+	SdfText::TextureAtlasRef result;
+	// Look for the texture atlas 
+	auto it = mTrackedTextureAtlases.find( key );
+	// ...or any atlas of the same format that already contains all of the glyphs
+	if( mTrackedTextureAtlases.end() == it ) {
+		it = findSupersetAtlas( key );
+		if( mTrackedTextureAtlases.end() != it ) {
+			++mAtlasCacheSubsetHits;
+		}
+	}
+	// Use the texture atlas if a matching one is found
+	if( mTrackedTextureAtlases.end() != it ) {
+		result = it->second.mAtlas;
+		it->second.mLastUsed = ++mAtlasCacheTick;
+		++mAtlasCacheHits;
+		return result;
+	}
+
+	// ...otherwise build a new one without holding the lock, so that threads build atlases of other faces and formats in parallel
+	std::promise<SdfText::TextureAtlasRef> promise;
+	mPendingTextureAtlases[key] = promise.get_future().share();
+	lock.unlock();
+	fs::path cachePath;
+	try {
+		if( derived ) {
+			SdfText::Format sourceFormat = requestedFormat;
+			sourceFormat.sdfScale( pyramidSdfScale );
+			SdfText::TextureAtlasRef source = getTextureAtlas( faces, sourceFormat, utf8Chars, glyphs );
+			// Another thread may still be generating the pages to derive from
+			source->waitUntilComplete();
+			if( source->getCompressedPages().size() == source->getNumPages() ) {
+				result = SdfText::TextureAtlas::createDerived( *source, format );
+				++mAtlasCacheDerived;
+			}
+		}
+		if( ! result ) {
+			result = loadOrCreateTextureAtlas( key, faces, format, utf8Chars, glyphs, &cachePath );
+		}
+	}
+	catch( ... ) {
+		lock.lock();
+		mPendingTextureAtlases.erase( key );
+		promise.set_exception( std::current_exception() );
+		throw;
+	}
+
+	lock.lock();
+	for( const auto& face : faces ) {
+		auto faceIt = mTrackedFaces.find( face );
+		if( mTrackedFaces.end() != faceIt ) {
+			result->retainFace( faceIt->second.lock() );
+		}
+	}
+	SdfText::TextureAtlas::CacheEntry entry;
+	entry.mAtlas = result;
+	entry.mLastUsed = ++mAtlasCacheTick;
+	mTrackedTextureAtlases[key] = entry;
+	mPendingTextureAtlases.erase( key );
+	// Make room for the new atlas if a budget is set
+	if( mAtlasCacheBudget > 0 ) {
+		evictUnusedAtlases( mAtlasCacheBudget );
+	}
+	promise.set_value( result );
+	lock.unlock();
+
+	// A new static atlas is published laid out, its pages follow in priority order
+	if( ! result->isComplete() ) {
+		if( onPublished ) {
+			onPublished();
+		}
+		try {
+			generateTextureAtlas( result, key, cachePath, format );
+		}
+		catch( ... ) {
+			// Whoever has the atlas keeps the pages generated so far, the next lookup builds it again
+			lock.lock();
+			auto trackedIt = mTrackedTextureAtlases.find( key );
+			if( ( mTrackedTextureAtlases.end() != trackedIt ) && ( result == trackedIt->second.mAtlas ) ) {
+				mTrackedTextureAtlases.erase( trackedIt );
+			}
+			lock.unlock();
+			result->completePages();
+			throw;
+		}
 	}
 
-#if defined( CINDER_MAC )
-//	[nsFontManager release];
-#elif defined( CINDER_WINRT )
-#elif defined( CINDER_ANDROID ) || defined( CINDER_LINUX )
-#endif
+	return result;
 }
 
-SdfTextManager* SdfTextManager::instance()
+void SdfTextManager::generateTextureAtlas( const SdfText::TextureAtlasRef &atlas, const SdfText::TextureAtlas::CacheKey &key, const fs::path &cachePath, const SdfText::Format &format )
 {
-	if( nullptr == SdfTextManager::sInstance ) {
-		SdfTextManager::sInstance =  new SdfTextManager();
-		if( nullptr != SdfTextManager::sInstance ) {
-			ci::app::App::get()->getSignalShouldQuit().connect( SdfTextFontManager_destroyStaticInstance );
+	atlas->generatePages();
+
+	// Saving needs the compressed pages, they're dropped afterwards unless the format asks for them
+	if( ! cachePath.empty() ) {
+		if( ! fs::exists( cachePath.parent_path() ) ) {
+			fs::create_directories( cachePath.parent_path() );
+		}
+		if( ! atlas->save( cachePath, key ) ) {
+			CI_LOG_W( "Failed to write atlas cache file: " << cachePath );
+		}
+		if( ! format.getKeepCompressedPages() ) {
+			atlas->releaseCompressedPages();
 		}
 	}
-	
-	return SdfTextManager::sInstance;
+
+	atlas->completePages();
 }
 
-#if defined( CINDER_MAC )
-void SdfTextManager::acquireFontNamesAndPaths()
+fs::path SdfTextManager::getAtlasDiskCachePath( const fs::path &directory, const SdfText::TextureAtlas::CacheKey &key )
 {
+	const size_t hash = SdfText::TextureAtlas::CacheKey::Hasher()( key );
+	return directory / ( "sdftext_atlas_" + std::to_string( hash ) + ".bin" );
 }
-#elif defined( CINDER_MSW )
-void SdfTextManager::acquireFontNamesAndPaths()
-{
-	static const LPWSTR kFontRegistryPath = L"Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts";
 
-	// Open Windows font registry key
-	HKEY hKey = nullptr;
-	LONG result = RegOpenKeyEx( HKEY_LOCAL_MACHINE, kFontRegistryPath, 0, KEY_READ, &hKey );
-	if( ERROR_SUCCESS != result ) {
-		return;
-	}
-	
-	// Get info for registry key
-	DWORD maxValueNameSize, maxValueDataSize;
-	result = RegQueryInfoKey( hKey, 0, 0, 0, 0, 0, 0, 0, &maxValueNameSize, &maxValueDataSize, 0, 0 );
-	if( ERROR_SUCCESS != result ) {
-		return;
+SdfText::TextureAtlasRef SdfTextManager::loadOrCreateTextureAtlas( const SdfText::TextureAtlas::CacheKey &key, const std::vector<FT_Face> &faces, const SdfText::Format &format, const std::string &utf8Chars, const SdfText::TextureAtlas::GlyphIndices &glyphs, fs::path *cachePath )
+{
+	fs::path directory;
+	{
+		std::lock_guard<std::recursive_mutex> lock( mMutex );
+		directory = mAtlasDiskCacheDirectory;
 	}
 
-	DWORD valueIndex = 0;
-	LPWSTR valueName = new WCHAR[maxValueNameSize];
-	LPBYTE valueData = new BYTE[maxValueDataSize];
-	DWORD valueNameSize, valueDataSize, valueType;
-
-	// Enumerate registry keys
-	do {
-		valueNameSize = maxValueNameSize;
-		valueDataSize = maxValueDataSize;
-
-		// Clear the buffers
-		std::memset( valueName, 0, maxValueNameSize*sizeof( WCHAR ) );
-		std::memset( valueData, 0, maxValueDataSize*sizeof( BYTE ) );
-
-		// Read registry key values
-		result = RegEnumValue( hKey, valueIndex, valueName, &valueNameSize, 0, &valueType, valueData, &valueDataSize );
-		++valueIndex;
+	SdfText::TextureAtlasRef result;
+	// Dynamic and Unicode block atlases have no pages to store up front, the atlases of the blocks are stored on their own
+	if( directory.empty() || format.getDynamic() || format.getUnicodeBlocks() ) {
+		result = SdfText::TextureAtlas::create( faces, format, utf8Chars, glyphs );
+		++mAtlasCacheMisses;
+		return result;
+	}
 
-		// Bail if read fails
-		if( ( ERROR_SUCCESS != result ) || ( REG_SZ != valueType ) ) {
-			continue;
+	const fs::path path = getAtlasDiskCachePath( directory, key );
+	if( fs::exists( path ) ) {
+		// A corrupt file may still claim sizes that don't fit in memory
+		try {
+			result = SdfText::TextureAtlas::load( path, key, faces, format, utf8Chars );
 		}
-
-		// Build font info
-		const std::string kTrueTypeTag = "(TrueType)";
-		// Font name
-		std::wstring wsFontName = std::wstring( valueName, valueNameSize );
-		std::string fontName = ci::toUtf8( reinterpret_cast<const char16_t *>( wsFontName.c_str() ), wsFontName.length() * sizeof( char16_t ) );
-		// Font file path
-		//std::wstring wsFontFilePath = std::wstring( reinterpret_cast<LPWSTR>( valueData ), valueDataSize );
-		std::wstring wsFontFilePath;
-		for( size_t i = 0; i < valueDataSize; ++i ) {
-			WCHAR ch = reinterpret_cast<LPWSTR>( valueData )[i];
-			if( 0 == ch ) {
-				break;
-			}
-			wsFontFilePath.push_back( ch );		
+		catch( const std::exception &exc ) {
+			CI_LOG_W( "Failed to read atlas cache file: " << path << ", " << exc.what() );
+			result.reset();
 		}
-		std::string fontFilePath = ci::toUtf8( reinterpret_cast<const char16_t *>( wsFontFilePath.c_str() ), wsFontFilePath.length() * sizeof( char16_t ) );
-		// Process True Type font
-		if( std::string::npos != fontName.find( kTrueTypeTag ) ) {
-			boost::replace_all( fontName, kTrueTypeTag, "" );
-			boost::trim( fontName );
-			std::string fontKey = boost::to_lower_copy( fontName );
-			auto it = std::find_if( std::begin( mFontInfos ), std::end( mFontInfos ),
-				[fontKey]( const FontInfo& elem ) -> bool {
-					return elem.key == fontKey;
-				}
-			);
-			if( std::end( mFontInfos ) == it ) {
-				fontFilePath = "C:\\Windows\\Fonts\\" + fontFilePath;
-				if( fs::exists( fontFilePath ) ) {
-					// Build font info
-					FontInfo fontInfo = FontInfo( fontKey, fontName, fontFilePath );
-					mFontInfos.push_back( fontInfo );
-					mFontNames.push_back( fontName );
-
-					/*
-					FT_Face face = nullptr;
-					FT_Error ftErr = FT_New_Face( mLibrary, fontFilePath.c_str(), 0, &face );
-					if( FT_Err_Ok == ftErr ) {
-						std::string styleName = face->style_name;
-						boost::trim( styleName );
-						std::string styleKey = boost::to_lower_copy( styleName );
-						if( "regular" != styleKey ) {
-							fontKey = fontKey + " " + styleKey;
-							fontName = fontName + " " + styleName;
-						}
-						// Build font info
-						FontInfo fontInfo = FontInfo( fontKey, fontName, fontFilePath );
-						mFontInfos.push_back( fontInfo );
-						mFontNames.push_back( fontName );
-						// Destroy face
-						FT_Done_Face( face );
-					}
-					*/
-				}
-			}
+		if( result ) {
+			++mAtlasCacheDiskHits;
+			return result;
 		}
-	} 
-	while( ERROR_NO_MORE_ITEMS != result  );
+		CI_LOG_W( "Ignoring invalid atlas cache file: " << path );
+	}
 
-	delete [] valueName;
-	delete [] valueData;
+	// Saving needs the compressed pages, see generateTextureAtlas()
+	SdfText::Format buildFormat = format;
+	buildFormat.keepCompressedPages();
+	result = SdfText::TextureAtlas::create( faces, buildFormat, utf8Chars, glyphs );
+	++mAtlasCacheMisses;
+	*cachePath = path;
+
+	return result;
 }
-#elif defined( CINDER_WINRT ) 
-void SdfTextManager::acquireFontNamesAndPaths()
+
+SdfText::TextureAtlas::AtlasCacher::iterator SdfTextManager::findSupersetAtlas( const SdfText::TextureAtlas::CacheKey &key )
 {
+	// Only reached on a miss, which is followed by a full atlas build, so a linear scan is fine. 
+	// Prefer the smallest superset to keep the glyph lookups of the caller small.
+	auto result = mTrackedTextureAtlases.end();
+	for( auto it = mTrackedTextureAtlases.begin(); it != mTrackedTextureAtlases.end(); ++it ) {
+		const auto& candidate = it->first;
+		if( ( ! key.isSameFormat( candidate ) ) || ( ! key.isSubsetOf( candidate ) ) ) {
+			continue;
+		}
+		if( ( mTrackedTextureAtlases.end() == result ) || ( candidate.getNumGlyphs() < result->first.getNumGlyphs() ) ) {
+			result = it;
+		}
+	}
+	return result;
 }
-#elif defined( CINDER_ANDROID )
-void SdfTextManager::acquireFontNamesAndPaths()
-{
-	fs::path systemFontDir = "/system/fonts";
-	if( fs::exists( systemFontDir ) && fs::is_directory( systemFontDir ) ) {
-		fs::directory_iterator end_iter;
-		for( fs::directory_iterator dir_iter( systemFontDir ) ; dir_iter != end_iter ; ++dir_iter ) {
-			if( fs::is_regular_file( dir_iter->status() ) ) {
-				fs::path fontPath = dir_iter->path();
 
-				FT_Face tmpFace;
-				FT_Error error = FT_New_Face( mLibrary, fontPath.string().c_str(), 0, &tmpFace );
-				if( error ) {
-					continue;
-				}
+void SdfTextManager::evictUnusedAtlases( size_t budget )
+{
+	size_t totalBytes = 0;
+	std::vector<SdfText::TextureAtlas::AtlasCacher::iterator> candidates;
+	for( auto it = mTrackedTextureAtlases.begin(); it != mTrackedTextureAtlases.end(); ++it ) {
+		totalBytes += it->second.mAtlas->getOwnGpuBytes();
+		if( it->second.isUnused() ) {
+			candidates.push_back( it );
+		}
+	}
 
-				std::string fontName = ci::linux::ftutil::GetFontName( tmpFace, fontPath.stem().string() );
-				std::string keyName = fontName;
-				std::transform( keyName.begin(), keyName.end(), keyName.begin(), [](char c) -> char { return (c >= 'A' && c <='Z') ? (c + 32) : c; } );
-				mFontInfos.push_back( FontInfo( keyName, fontName, fontPath ) );
+	if( totalBytes <= budget ) {
+		return;
+	}
 
-				const std::string regular = "regular";
-				size_t startPos = keyName.find( regular );
-				if( std::string::npos != startPos ) {
-					keyName.replace( startPos, regular.length(), "" );
-					mFontInfos.push_back( FontInfo( keyName, fontName, fontPath ) );
-				} 	
+	// Oldest first
+	std::sort( std::begin( candidates ), std::end( candidates ),
+		[]( const SdfText::TextureAtlas::AtlasCacher::iterator& a, const SdfText::TextureAtlas::AtlasCacher::iterator& b ) -> bool {
+			return a->second.mLastUsed < b->second.mLastUsed;
+		}
+	);
 
-				FT_Done_Face( tmpFace );
-			}
+	for( auto& it : candidates ) {
+		if( totalBytes <= budget ) {
+			break;
 		}
+		totalBytes -= it->second.mAtlas->getOwnGpuBytes();
+		mTrackedTextureAtlases.erase( it );
+		++mAtlasCacheEvictions;
 	}
 }
-#elif defined( CINDER_LINUX )
-void SdfTextManager::acquireFontNamesAndPaths()
-{
-}
-#endif
 
-void SdfTextManager::faceCreated( FT_Face face ) 
+std::vector<std::pair<SdfText::TextureAtlasRef, bool>> SdfTextManager::getTrackedAtlases() const
 {
-	mTrackedFaces.insert( face );
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	std::vector<std::pair<SdfText::TextureAtlasRef, bool>> result;
+	result.reserve( mTrackedTextureAtlases.size() );
+	for( const auto& it : mTrackedTextureAtlases ) {
+		result.emplace_back( it.second.mAtlas, it.second.isUnused() );
+	}
+	return result;
 }
 
-void SdfTextManager::faceDestroyed( FT_Face face ) 
+SdfText::AtlasCacheStats SdfTextManager::getAtlasCacheStats() const
 {
-	mTrackedFaces.erase( face );
+	SdfText::AtlasCacheStats result;
+	result.hits = mAtlasCacheHits;
+	result.subsetHits = mAtlasCacheSubsetHits;
+	result.misses = mAtlasCacheMisses;
+	result.diskHits = mAtlasCacheDiskHits;
+	result.derived = mAtlasCacheDerived;
+	result.evictions = mAtlasCacheEvictions;
+	{
+		std::lock_guard<std::recursive_mutex> lock( mMutex );
+		result.budget = mAtlasCacheBudget;
+	}
+	// The atlases are queried without the manager lock, which they never take while holding their own
+	uint64_t numTexels = 0;
+	for( const auto& it : getTrackedAtlases() ) {
+		const SdfText::AtlasStats atlasStats = it.first->getAtlasStats();
+		++result.numAtlases;
+		if( it.second ) {
+			++result.numUnusedAtlases;
+		}
+		// The pages and glyphs of a Unicode block atlas are counted with the atlases of its blocks
+		if( it.first->isUnicodeBlocks() ) {
+			result.mapBytes += atlasStats.mapBytes;
+			continue;
+		}
+		result.gpuBytes += atlasStats.gpuBytes;
+		result.cpuBytes += atlasStats.cpuBytes;
+		result.mapBytes += atlasStats.mapBytes;
+		result.numGlyphs += atlasStats.numGlyphs;
+		result.numPages += atlasStats.layout.numPages;
+		result.wastedTexels += atlasStats.wastedTexels;
+		result.buildTime += atlasStats.buildTime;
+		numTexels += it.first->getNumTexels();
+	}
+	result.fillRatio = ( numTexels > 0 ) ? static_cast<float>( 1.0 - static_cast<double>( result.wastedTexels ) / static_cast<double>( numTexels ) ) : 0.0f;
+	return result;
 }
 
-SdfText::TextureAtlasRef SdfTextManager::getTextureAtlas( FT_Face face, const SdfText::Format &format, const std::string &utf8Chars )
+std::vector<SdfText::AtlasStats> SdfTextManager::getCachedAtlasStats() const
 {
-	std::u32string utf32Chars = ci::toUtf32( utf8Chars );
-	// Add a space if needed
-	if( std::string::npos == utf8Chars.find( ' ' ) ) {
-		utf32Chars += ci::toUtf32( " " );
-	}
-
-	// Build the maps and information pieces that will be needed later
-	vec2 maxGlyphSize = vec2( 0 );
-	for( const auto& ch : utf32Chars ) {
-		FT_UInt glyphIndex = FT_Get_Char_Index( face, static_cast<FT_ULong>( ch ) );
-		// Glyph bounds, 
-		msdfgen::Shape shape;
-		if( msdfgen::loadGlyph( shape, face, glyphIndex ) ) {
-			double l, b, r, t;
-			l = b = r = t = 0.0;
-			shape.bounds( l, b, r, t );
-			// Glyph bounds
-			Rectf bounds = Rectf( 
-				static_cast<float>( l ), 
-				static_cast<float>( b ), 
-				static_cast<float>( r ), 
-				static_cast<float>( t ) );
-			// Max glyph size
-			maxGlyphSize.x = std::max( maxGlyphSize.x, bounds.getWidth() );
-			maxGlyphSize.y = std::max( maxGlyphSize.y, bounds.getHeight() );
-		}	
+	std::vector<SdfText::AtlasStats> result;
+	for( const auto& it : getTrackedAtlases() ) {
+		result.push_back( it.first->getAtlasStats() );
 	}
-	
-	SdfText::TextureAtlas::CacheKey key;
-	key.mFamilyName = std::string( face->family_name );
-	key.mStyleName = std::string( face->style_name );
-	key.mUtf8Chars = utf8Chars;
-	key.mTextureSize = format.getTextureSize();
-	key.mSdfBitmapSize = SdfText::TextureAtlas::calculateSdfBitmapSize( format.getSdfScale(), format.getSdfPadding(), maxGlyphSize );
+	return result;
+}
 
-	// Result
-	SdfText::TextureAtlasRef result;
-	// Look for the texture atlas 
-	auto it = std::find_if( std::begin( mTrackedTextureAtlases ), std::end( mTrackedTextureAtlases ),
-		[key]( const std::pair<SdfText::TextureAtlas::CacheKey, SdfText::TextureAtlasRef>& elem ) -> bool {
-			return elem.first == key;
-		}
-	);
-	// Use the texture atlas if a matching one is found
-	if( mTrackedTextureAtlases.end() != it ) {
-		result = it->second;
-	}
-	// ...otherwise build a new one
-	else {
-		result = SdfText::TextureAtlas::create( face, format, utf8Chars );
-		mTrackedTextureAtlases.push_back( std::make_pair( key, result ) );
+void SdfTextManager::setAtlasCacheBudget( size_t bytes )
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	mAtlasCacheBudget = bytes;
+	if( mAtlasCacheBudget > 0 ) {
+		evictUnusedAtlases( mAtlasCacheBudget );
 	}
+}
 
-	return result;
+void SdfTextManager::purgeUnusedAtlases()
+{
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
+	evictUnusedAtlases( 0 );
 }
 
 SdfTextManager::FontInfo SdfTextManager::getFontInfo( const std::string& fontName ) const
 {
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
 	SdfTextManager::FontInfo result;
 
 #if defined( CINDER_MAC )
@@ -795,50 +3287,42 @@ SdfTextManager::FontInfo SdfTextManager::getFontInfo( const std::string& fontNam
 	std::string lcfn = boost::to_lower_copy( fontName );
 	boost::trim( lcfn );
 
-	auto it = std::find_if( std::begin( mFontInfos ), std::end( mFontInfos ),
-		[lcfn]( const SdfTextManager::FontInfo &elem ) -> bool {
-			return elem.key == lcfn;
-		}
-	);
+	const size_t keyIndex = mFontNameIndex.findKey( lcfn );
+	if( FontNameIndex::npos != keyIndex ) {
+		return mFontInfos[keyIndex];
+	}
 
-	if( std::end( mFontInfos ) != it ) {
-		result = *it;
+	auto matchIt = mFuzzyFontMatches.find( lcfn );
+	if( mFuzzyFontMatches.end() == matchIt ) {
+		matchIt = mFuzzyFontMatches.insert( std::make_pair( lcfn, mFontNameIndex.findBestMatch( lcfn ) ) ).first;
 	}
-	else {
-		std::vector<std::string> tokens = ci::split( lcfn, ' ' );
-		float highScore = 0.0f;
-		for( const auto& fontInfos : mFontInfos ) {
-			int hits = 0;
-			for( const auto& tok : tokens ) {
-				if( std::string::npos != fontInfos.key.find( tok ) ) {
-					hits += static_cast<int>( tok.size() );	
-				}
-			}
 
-			if( hits > 0 ) {
-				std::vector<std::string> keyTokens = ci::split( fontInfos.key, ' ' );
-				float keyScore = ( keyTokens.size() == tokens.size() ) ? 0.25f : 0.0f;
-				float hitScore = static_cast<float>( hits ) / static_cast<float>( fontInfos.key.length() - ( keyTokens.size() - 1 ) );
-				hitScore = 0.75f * std::min( hitScore, 1.0f );
-				float totalScore = keyScore + hitScore;
-				if( totalScore > highScore ) {
-					highScore = totalScore;
-					result = fontInfos;
-				}
-			}
-		}
+	if( FontNameIndex::npos != matchIt->second ) {
+		result = mFontInfos[matchIt->second];
 	}
 
 	return result;
 }
 
+void SdfTextManager::buildFontIndex()
+{
+	std::vector<std::string> keys;
+	for( const auto& fontInfo : mFontInfos ) {
+		keys.push_back( fontInfo.key );
+	}
+	mFontNameIndex.build( keys );
+	mFuzzyFontMatches.clear();
+}
+
 const std::vector<std::string>& SdfTextManager::getNames( bool forceRefresh )
 {
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
 	if( ( ! mFontsEnumerated ) || forceRefresh ) {
 		mFontInfos.clear();
 		mFontNames.clear();
 
 		acquireFontNamesAndPaths();
+#if defined( CINDER_MSW )
 		// Registry operations can be rejected by Windows so no fonts will be picked up 
 		// on the initial scan. So we can multiple times.
 		if( mFontInfos.empty() ) {
@@ -847,9 +3331,11 @@ const std::vector<std::string>& SdfTextManager::getNames( bool forceRefresh )
 				if( ! mFontInfos.empty() ) {
 					break;
 				}
-//				::Sleep( 10 );
+				::Sleep( 10 );
 			}
 		}
+#endif
+		buildFontIndex();
 
 		mFontsEnumerated = true;
 	}
@@ -931,6 +3417,7 @@ const std::vector<std::string>& SdfTextManager::getNames( bool forceRefresh )
 
 SdfText::Font SdfTextManager::getDefault() const
 {
+	std::lock_guard<std::recursive_mutex> lock( mMutex );
 	if( ! mDefault ) {
 #if defined( CINDER_COCOA )        
 		mDefault = SdfText::Font( "Helvetica", 32.0f );
@@ -956,8 +3443,8 @@ struct LineProcessor
 
 struct LineMeasure 
 {
-	LineMeasure( float maxWidth, const SdfText::Font &font, const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics ) 
-		: mMaxWidth( maxWidth ), mFace( font.getFace() ), mCachedGlyphMerics( cachedGlyphMetrics ) {}
+	LineMeasure( float maxWidth, FT_Face face, const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics ) 
+		: mMaxWidth( maxWidth ), mFace( face ), mCachedGlyphMerics( cachedGlyphMetrics ) {}
 
 	bool operator()( const char *line, size_t len ) const {
 		if( mMaxWidth >= MAX_SIZE ) {
@@ -973,6 +3460,9 @@ struct LineMeasure
 			FT_UInt glyphIndex = FT_Get_Char_Index( mFace, ch );
 
 			auto iter = mCachedGlyphMerics.find( glyphIndex );
+			if( mCachedGlyphMerics.end() == iter ) {
+				continue;
+			}
 			advance = iter->second.advance;		
 
 			pen.x += advance.x;
@@ -990,14 +3480,22 @@ struct LineMeasure
 	const SdfText::Font::GlyphMetricsMap	&mCachedGlyphMerics;
 };
 
-std::vector<std::string> SdfTextBox::calculateLineBreaks( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics ) const
+std::vector<std::string> SdfTextBox::calculateLineBreaks( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics, float sizeScale ) const
 {
 	std::vector<std::string> result;
 	std::function<void(const char *,size_t)> lineFn = LineProcessor( &result );		
-	lineBreakUtf8( mText.c_str(), LineMeasure( ( mSize.x > 0 ) ? static_cast<float>( mSize.x ) : MAX_SIZE, mFont, cachedGlyphMetrics ), lineFn );
+	// Measure against the width at the size of the font rather than scaling every advance
+	SdfText::Font::LockedFace face = mFont.getFace();
+	lineBreakUtf8( mText.c_str(), LineMeasure( ( mSize.x > 0 ) ? ( static_cast<float>( mSize.x ) / sizeScale ) : MAX_SIZE, face.get(), cachedGlyphMetrics ), lineFn );
 	return result;
 }
 
+//! Returns the ratio of the size in \a options to the size of \a font, 1 if \a options doesn't set a size
+static float getSizeScale( const SdfText::Font &font, const SdfText::DrawOptions &options )
+{
+	return ( ( options.getSize() > 0.0f ) && ( font.getSize() > 0.0f ) ) ? ( options.getSize() / font.getSize() ) : 1.0f;
+}
+
 SdfText::Font::GlyphMeasures SdfTextBox::measureGlyphs( const SdfText::Font::GlyphMetricsMap &cachedGlyphMetrics, const SdfText::DrawOptions& drawOptions ) const
 {
 	SdfText::Font::GlyphMeasures result;
@@ -1006,10 +3504,11 @@ SdfText::Font::GlyphMeasures SdfTextBox::measureGlyphs( const SdfText::Font::Gly
 		return result;
 	}
 
-	FT_Face face = mFont.getFace();
-	std::vector<std::string> mLines = calculateLineBreaks( cachedGlyphMetrics );
+	SdfText::Font::LockedFace face = mFont.getFace();
+	const float sizeScale = getSizeScale( mFont, drawOptions );
+	std::vector<std::string> mLines = calculateLineBreaks( cachedGlyphMetrics, sizeScale );
 
-	const float fontSizeScale = mFont.getSize() / 32.0f;
+	const float fontSizeScale = sizeScale * mFont.getSize() / 32.0f;
 	const float ascent        = mFont.getAscent();
 	const float descent       = mFont.getDescent();
 	const float leading       = drawOptions.getLeading();
@@ -1023,7 +3522,7 @@ SdfText::Font::GlyphMeasures SdfTextBox::measureGlyphs( const SdfText::Font::Gly
 		vec2 pen = { 0, 0 };
 		for( const auto& ch : utf32Chars ) {
 			vec2 advance = { 0, 0 };
-			FT_UInt glyphIndex = FT_Get_Char_Index( face, ch );
+			FT_UInt glyphIndex = FT_Get_Char_Index( face.get(), ch );
 
 			auto iter = cachedGlyphMetrics.find( glyphIndex );
 			if( cachedGlyphMetrics.end() == iter ) {
@@ -1031,7 +3530,7 @@ SdfText::Font::GlyphMeasures SdfTextBox::measureGlyphs( const SdfText::Font::Gly
 			}
 			advance = iter->second.advance;
 
-			float xPos = pen.x;
+			float xPos = sizeScale * pen.x;
 			result.push_back( std::make_pair( (uint32_t)glyphIndex, vec2( xPos, curY ) ) );
 
 			pen += advance;
@@ -1043,58 +3542,124 @@ SdfText::Font::GlyphMeasures SdfTextBox::measureGlyphs( const SdfText::Font::Gly
 	return result;
 }
 
+// =================================================================================================
+// FontFace
+// =================================================================================================
+FontFace::~FontFace()
+{
+	auto fontManager = SdfTextManager::sInstance.load();
+	if( nullptr != fontManager ) {
+		fontManager->releaseFace( mFace );
+	}
+}
+
+FontFaceRef FontFace::create( const FontFileRef &file, uint32_t faceIndex )
+{
+	if( ! file ) {
+		return FontFaceRef();
+	}
+
+	auto fontManager = SdfTextManager::instance();
+	FontFaceRef result = FontFaceRef( new FontFace() );
+	result->mFile = file;
+	FT_Error ftRes = FT_Err_Ok;
+	{
+		// Faces are added to the library, which is shared by all threads
+		std::lock_guard<std::recursive_mutex> lock( fontManager->mMutex );
+		ftRes = FT_New_Memory_Face(
+			fontManager->getLibrary(),
+			reinterpret_cast<const FT_Byte*>( file->getData() ),
+			static_cast<FT_Long>( file->getSize() ),
+			static_cast<FT_Long>( faceIndex ),
+			&result->mFace
+		);
+	}
+
+	if( FT_Err_Ok != ftRes ) {
+		throw std::runtime_error("Failed to load font data");
+	}
+
+	FT_Select_Charmap( result->mFace, FT_ENCODING_UNICODE );
+	fontManager->faceCreated( result );
+	return result;
+}
+
+// =================================================================================================
+// SdfText::Format
+// =================================================================================================
+SdfText::Format& SdfText::Format::glyphPriorities( const std::string &utf8Text )
+{
+	mGlyphPriorities.clear();
+	for( const auto& ch : ci::toUtf32( utf8Text ) ) {
+		mGlyphPriorities[static_cast<uint32_t>( ch )] += 1.0f;
+	}
+	return *this;
+}
+
 // =================================================================================================
 // SdfText::FontData
 // =================================================================================================
 class SdfText::FontData {
 public:
-	FontData( const ci::DataSourceRef &dataSource ) {
-		if(! dataSource) {
+	FontData( const FontFaceRef &face, float size )
+		: mFace( face )
+	{
+		if( ! mFace ) {
 			return;
 		}
 
-		mFileData = dataSource->getBuffer();
-		if( ! mFileData ) {
-			return;
+		// Fonts of other sizes share the face, each one keeps its own size
+		FT_Face ftFace = mFace->getFace();
+		FaceLock faceLock = lockFace( ftFace );
+		if( FT_Err_Ok == FT_New_Size( ftFace, &mSize ) ) {
+			FT_Activate_Size( mSize );
+			FT_F26Dot6 finalSize = static_cast<FT_F26Dot6>( size * 64.0f );
+			FT_Set_Char_Size( ftFace, 0, finalSize , 0, 72 );
 		}
+	}
 
-		auto fontManager = SdfTextManager::instance();
-		if( nullptr != fontManager ) {
-			FT_Error ftRes = FT_New_Memory_Face(
-				fontManager->getLibrary(),
-				reinterpret_cast<FT_Byte*>( mFileData->getData() ),
-				static_cast<FT_Long>( mFileData->getSize() ),
-				0,
-				&mFace
-			);
-
-			if( FT_Err_Ok != ftRes ) {
-				throw std::runtime_error("Failed to load font data");
-			}
-
-			fontManager->faceCreated( mFace );
+	virtual ~FontData() {
+		auto fontManager = SdfTextManager::sInstance.load();
+		if( ( nullptr != mSize ) && ( nullptr != fontManager ) && fontManager->isFaceAlive( mFace->getFace() ) ) {
+			FaceLock faceLock = lockFace( mFace->getFace() );
+			FT_Done_Size( mSize );
 		}
 	}
 
-	virtual ~FontData() {
-		auto fontManager = SdfTextManager::instance();
-		if( ( nullptr != fontManager ) && ( nullptr != mFace ) ) {
-			fontManager->faceDestroyed( mFace );
+	static SdfText::FontDataRef create( const ci::DataSourceRef &dataSource, uint32_t faceIndex, float size ) {
+		FontFaceRef face;
+		if( dataSource ) {
+			// Faces of files are opened once and shared with every other font of the same face
+			face = dataSource->isFilePath() ? SdfTextManager::instance()->getFontFace( dataSource->getFilePath(), faceIndex ) : FontFace::create( FontFile::create( dataSource->getBuffer() ), faceIndex );
 		}
+		SdfText::FontDataRef result = SdfText::FontDataRef( new SdfText::FontData( face, size ) );
+		return result;
+	}
+
+	//! Returns the face with the size of this font active, locked for as long as the result is held
+	SdfText::Font::LockedFace getFace() const {
+		FaceLock faceLock = lock();
+		return SdfText::Font::LockedFace( mFace ? mFace->getFace() : nullptr, std::move( faceLock ) );
 	}
 
-	static SdfText::FontDataRef create( const ci::DataSourceRef &dataSource ) {
-		SdfText::FontDataRef result = SdfText::FontDataRef( new SdfText::FontData( dataSource ) );
+	//! Returns the face without locking it, only to identify it such as by the atlases, which lock it themselves
+	FT_Face	getFaceId() const { return mFace ? mFace->getFace() : nullptr; }
+
+	//! Locks the face against use from other threads and activates the size of this font
+	FaceLock lock() const {
+		if( ! mFace ) {
+			return FaceLock();
+		}
+		FaceLock result = lockFace( mFace->getFace() );
+		if( nullptr != mSize ) {
+			FT_Activate_Size( mSize );
+		}
 		return result;
 	}
 
-	FT_Face	getFace() const {
-		return mFace;
-	}
-
 private:
-	ci::BufferRef	mFileData;
-	FT_Face			mFace = nullptr;
+	FontFaceRef		mFace;
+	FT_Size			mSize = nullptr;
 };
 
 // =================================================================================================
@@ -1111,23 +3676,18 @@ SdfText::Font::Font( const std::string &name, float size )
 		}
 
 		auto dataSource = ci::loadFile( info.path );
-		loadFontData( dataSource );
+		loadFontData( dataSource, info.faceIndex );
 	}
 }
 
 SdfText::Font::Font( DataSourceRef dataSource, float size )
 	: mSize( size )
 {
-	if( dataSource->isFilePath() ) {
-		auto fontDataSource = ci::loadFile( dataSource->getFilePath() );
-		loadFontData( fontDataSource );
-	}
-	else {
-		loadFontData( dataSource );
-	}
+	loadFontData( dataSource );
 
+	SdfText::Font::LockedFace face = mData->getFace();
 	FT_SfntName sn = {};
-	if( FT_Err_Ok == FT_Get_Sfnt_Name( mData->getFace(), TT_NAME_ID_FULL_NAME, &sn ) ) {
+	if( FT_Err_Ok == FT_Get_Sfnt_Name( face.get(), TT_NAME_ID_FULL_NAME, &sn ) ) {
 		// Possible Unicode name, just use filename for now
 		if( sn.string_len > 0  && ( 0 == sn.string[0] ) ) {
 			mName = "(Unknown)";
@@ -1142,36 +3702,36 @@ SdfText::Font::~Font()
 {
 }
 
-void SdfText::Font::loadFontData( const ci::DataSourceRef &dataSource )
+void SdfText::Font::loadFontData( const ci::DataSourceRef &dataSource, uint32_t faceIndex )
 {
-	mData = SdfText::FontData::create( dataSource );
-	FT_Select_Charmap( mData->getFace(), FT_ENCODING_UNICODE );
-
-	FT_F26Dot6 finalSize = static_cast<FT_F26Dot6>( mSize * 64.0f );
-	FT_Set_Char_Size( mData->getFace(), 0, finalSize , 0, 72 );
+	mData = SdfText::FontData::create( dataSource, faceIndex, mSize );
 }
 
 float SdfText::Font::getHeight() const
 {
-	float result = ( mData->getFace()->height / 64.0f );
+	SdfText::Font::LockedFace face = mData->getFace();
+	float result = ( face->height / 64.0f );
 	return result;
 }
 
 float SdfText::Font::getLeading() const
 {
-	float result = ( mData->getFace()->height - ( std::abs( mData->getFace()->ascender ) + std::abs( mData->getFace()->descender ) ) ) / 64.0f;
+	SdfText::Font::LockedFace face = mData->getFace();
+	float result = ( face->height - ( std::abs( face->ascender ) + std::abs( face->descender ) ) ) / 64.0f;
 	return result;
 }
 
 float SdfText::Font::getAscent() const
 {
-	float result = std::fabs( mData->getFace()->ascender / 64.0f );
+	SdfText::Font::LockedFace face = mData->getFace();
+	float result = std::fabs( face->ascender / 64.0f );
 	return result;
 }
 
 float SdfText::Font::getDescent() const
 {
-	float result = std::fabs( mData->getFace()->descender / 64.0f );
+	SdfText::Font::LockedFace face = mData->getFace();
+	float result = std::fabs( face->descender / 64.0f );
 	return result;
 }
 
@@ -1182,24 +3742,26 @@ SdfText::Font::Glyph SdfText::Font::getGlyphIndex( size_t idx ) const
 
 SdfText::Font::Glyph SdfText::Font::getGlyphChar( char utf8Char ) const
 {
-	FT_UInt glyphIndex = FT_Get_Char_Index( mData->getFace(), static_cast<FT_ULong>( utf8Char ) );
+	SdfText::Font::LockedFace face = mData->getFace();
+	FT_UInt glyphIndex = FT_Get_Char_Index( face.get(), static_cast<FT_ULong>( utf8Char ) );
 	return static_cast<SdfText::Font::Glyph>( glyphIndex );
 }
 
 std::vector<SdfText::Font::Glyph> SdfText::Font::getGlyphs( const std::string &utf8Chars ) const
 {
 	std::vector<SdfText::Font::Glyph> result;
+	SdfText::Font::LockedFace face = mData->getFace();
 	// Convert to UTF32
 	std::u32string utf32Chars = ci::toUtf32( utf8Chars );
 	// Build the maps and information pieces that will be needed later
 	for( const auto& ch : utf32Chars ) {
-		FT_UInt glyphIndex = FT_Get_Char_Index( mData->getFace(), static_cast<FT_ULong>( ch ) );
+		FT_UInt glyphIndex = FT_Get_Char_Index( face.get(), static_cast<FT_ULong>( ch ) );
 		result.push_back( static_cast<SdfText::Font::Glyph>( glyphIndex ) );
 	}
 	return result;
 }
 
-FT_Face SdfText::Font::getFace() const
+SdfText::Font::LockedFace SdfText::Font::getFace() const
 {
 	return mData->getFace();
 }
@@ -1214,19 +3776,39 @@ SdfText::Font SdfText::Font::getDefault()
 	return SdfTextManager::instance()->getDefault();
 }
 
+void SdfText::Font::addFontDirectory( const fs::path &directory )
+{
+	SdfTextManager::instance()->addFontDirectory( directory );
+}
+
 // =================================================================================================
 // SdfText
 // =================================================================================================
-SdfText::SdfText( const SdfText::Font &font, const Format &format, const std::string &utf8Chars )
+SdfText::SdfText( const SdfText::Font &font, const Format &format, const std::string &utf8Chars, const std::vector<SdfText::Font::Glyph> &glyphs, const std::function<void()> &onAtlasPublished )
 	: mFont( font ), mFormat( format )
 {
-	FT_Face face = font.getFace();
+	// Only identifies the face, the atlas locks it while rendering. Holding the lock here would take it before the manager's.
+	FT_Face face = font.mData ? font.mData->getFaceId() : nullptr;
 	if( nullptr == face ) {
 		throw std::runtime_error( "null font face" );
 	}
 
-	mTextureAtlases = SdfTextManager::instance()->getTextureAtlas( face, format, utf8Chars );
+	mTextureAtlases = SdfTextManager::instance()->getTextureAtlas( { face }, format, utf8Chars, glyphs, onAtlasPublished );
+
+	// Cache glyph metrics
+	cacheGlyphMetrics();
+	cacheGlyphMetrics( glyphs );
+
+	// Dynamic and Unicode block atlases start out empty, add the requested glyphs now rather than on first draw. 
+	// They render into the textures, so without a GL context on this thread it's left to the first draw after all.
+	if( mTextureAtlases->isLoadedOnDemand() && ( ! glyphs.empty() ) && ( nullptr != gl::context() ) ) {
+		prepareGlyphs( glyphs );
+	}
+}
 
+SdfText::SdfText( const SdfText::Font &font, const Format &format, const TextureAtlasRef &textureAtlas, uint32_t faceSlot )
+	: mFont( font ), mFormat( format ), mTextureAtlases( textureAtlas ), mFaceSlot( faceSlot )
+{
 	// Cache glyph metrics
 	cacheGlyphMetrics();
 }
@@ -1237,218 +3819,196 @@ SdfText::~SdfText()
 
 SdfTextRef SdfText::create( const SdfText::Font &font, const Format &format, const std::string &supportedChars )
 {
-	SdfTextRef result = SdfTextRef( new SdfText( font, format, supportedChars ) );
+	SdfTextRef result = SdfTextRef( new SdfText( font, format, supportedChars, std::vector<SdfText::Font::Glyph>() ) );
 	return result;
 }
 
-void SdfText::drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const vec2 &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+SdfTextRef SdfText::create( const SdfText::Font &font, const Format &format, const std::vector<SdfText::Font::Glyph> &glyphs )
 {
-	const auto& textures = mTextureAtlases->mTextures;
-	const auto& glyphMap = mTextureAtlases->mGlyphInfo;
-	const auto& sdfScale = mTextureAtlases->mSdfScale;
-	const auto& sdfPadding = mTextureAtlases->mSdfPadding;
-	const auto& sdfBitmapSize = mTextureAtlases->mSdfBitmapSize;
-
-	if( textures.empty() ) {
-		return;
-	}
-
-	if( ! colors.empty() ) {
-		assert( glyphMeasures.size() == colors.size() );
-	}
+	SdfTextRef result = SdfTextRef( new SdfText( font, format, std::string(), glyphs ) );
+	return result;
+}
 
-	auto shader = options.getGlslProg();
-	if( ! shader ) {
-		if( options.getUseMinimalShader() ) {
-			if( ! sDefaultMinimalShader ) {
+SdfText::AsyncResultRef SdfText::createAsync( const SdfText::Font &font, const Format &format, const std::string &utf8Chars )
+{
+	// The pages of an atlas built without a GL context are staged until the GL thread uploads them
+	auto promise = std::make_shared<std::promise<SdfTextRef>>();
+	AsyncResultRef result = AsyncResultRef( new AsyncResult( promise->get_future().share() ) );
+	SdfTextManager::instance()->runInBackground( [promise, font, format, utf8Chars]() {
+		bool published = false;
+		try {
+			// A new static atlas is handed out as soon as it's laid out, this thread goes on generating its pages
+			auto onAtlasPublished = [&]() {
 				try {
-					sDefaultMinimalShader = gl::GlslProg::create( kSdfVertShader, kSdfFragMinimalShader );
+					promise->set_value( SdfText::create( font, format, utf8Chars ) );
+					published = true;
 				}
-				catch( const std::exception& e ) {
-					CI_LOG_E( "sDefaultMinimalShader error: " << e.what() );
+				catch( ... ) {
+					// Left to the result once the pages are generated
 				}
+			};
+			SdfTextRef text = SdfTextRef( new SdfText( font, format, utf8Chars, std::vector<SdfText::Font::Glyph>(), onAtlasPublished ) );
+			if( ! published ) {
+				promise->set_value( text );
 			}
-			shader = sDefaultMinimalShader;
 		}
-		else {
-			if( ! sDefaultShader ) {
-				try {
-					sDefaultShader = gl::GlslProg::create( kSdfVertShader, kSdfFragShader );
-				}
-				catch( const std::exception& e ) {
-					CI_LOG_E( "sDefaultShader error: " << e.what() );
-				}
+		catch( ... ) {
+			if( published ) {
+				CI_LOG_E( "Failed to generate the atlas pages of " << font.getName() );
+			}
+			else {
+				promise->set_exception( std::current_exception() );
 			}
-			shader = sDefaultShader;
 		}
+	} );
+	return result;
+}
+
+std::vector<SdfText::AsyncResultRef> SdfText::prewarm( const std::vector<PrewarmEntry> &manifest )
+{
+	std::vector<AsyncResultRef> result;
+	for( const auto& future : SdfTextManager::instance()->prewarm( manifest ) ) {
+		result.push_back( AsyncResultRef( new AsyncResult( future ) ) );
 	}
-	ScopedTextureBind texBindScp( textures[0] );
-	ScopedGlslProg glslScp( shader );
+	return result;
+}
 
-	vec2 baseline = baselineIn;
+SdfText::PrewarmProgress SdfText::getPrewarmProgress()
+{
+	return SdfTextManager::instance()->getPrewarmProgress();
+}
 
-	if( ! options.getGlslProg() ) {
-		shader->uniform( "uFgColor", gl::context()->getCurrentColor() );
-		shader->uniform( "uPremultiply", options.getPremultiply() ? 1.0f : 0.0f );
-		shader->uniform( "uGamma", options.getGamma() );
+std::vector<SdfTextRef> SdfText::createShared( const std::vector<SdfText::Font> &fonts, const Format &format, const std::string &supportedChars )
+{
+	std::vector<FT_Face> faces;
+	for( const auto& font : fonts ) {
+		FT_Face face = font.mData ? font.mData->getFaceId() : nullptr;
+		if( nullptr == face ) {
+			throw std::runtime_error( "null font face" );
+		}
+		faces.push_back( face );
 	}
 
-	const vec2 fontRenderScale = vec2( mFont.getSize() ) / ( 32.0f * mTextureAtlases->mSdfScale );
-	const vec2 fontOriginScale = vec2( mFont.getSize() ) / 32.0f;
+	// Faces occupy the atlas slots in the order given
+	SdfText::TextureAtlasRef textureAtlas = SdfTextManager::instance()->getTextureAtlas( faces, format, supportedChars );
 
-	const float scale = options.getScale();
-	for( size_t texIdx = 0; texIdx < textures.size(); ++texIdx ) {
-		std::vector<float> verts, texCoords;
-		std::vector<ColorA8u> vertColors;
-		const gl::TextureRef &curTex = textures[texIdx];
+	std::vector<SdfTextRef> result;
+	for( size_t i = 0; i < fonts.size(); ++i ) {
+		result.push_back( SdfTextRef( new SdfText( fonts[i], format, textureAtlas, static_cast<uint32_t>( i ) ) ) );
+	}
+	return result;
+}
 
-		std::vector<uint32_t> indices;
-		uint32_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_INT;
+// =================================================================================================
+// SdfText::AsyncResult
+// =================================================================================================
+bool SdfText::AsyncResult::isReady()
+{
+	if( mResult ) {
+		return true;
+	}
+	if( std::future_status::ready != mFuture.wait_for( std::chrono::seconds( 0 ) ) ) {
+		return false;
+	}
 
-		if( options.getPixelSnap() ) {
-			baseline = vec2( floor( baseline.x ), floor( baseline.y ) );
-		}
-			
-		for( std::vector<std::pair<SdfText::Font::Glyph,vec2> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
-			SdfText::TextureAtlas::GlyphInfoMap::const_iterator glyphInfoIt = glyphMap.find( glyphIt->first );
-			if(  glyphInfoIt == glyphMap.end() ) {
-				continue;
-			}
-				
-			const auto &glyphInfo = glyphInfoIt->second;
-			if( glyphInfo.mTextureIndex != texIdx ) {
-				continue;
-			}
+	// Off the GL thread the pages stay staged until the first draw
+	mResult = mFuture.get();
+	mResult->mTextureAtlases->finishPages();
+	return true;
+}
 
-			const auto &originOffset = glyphInfo.mOriginOffset;
-
-			Rectf srcTexCoords = curTex->getAreaTexCoords( glyphInfo.mTexCoords );
-			Rectf destRect = Rectf( glyphInfo.mTexCoords );
-			destRect.scale( scale );
-			destRect -= destRect.getUpperLeft();
-			vec2 offset = vec2( 0, -( destRect.getHeight() ) );
-			// Reverse the transformation applied during SDF generation
-			float tx = sdfPadding.x;
-			float ty = std::fabs( originOffset.y ) + sdfPadding.y;
-			offset += scale * sdfScale * vec2( -tx, ty );
-			// Use origin scale for horizontal offset
-			offset += scale * fontOriginScale * vec2( originOffset.x, 0.0f );
-			destRect += offset;
-			destRect.scale( fontRenderScale );
-
-			destRect += glyphIt->second * scale;
-			destRect += baseline;
-			
-			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY1() );
-			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY1() );
-			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY2() );
-			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY2() );
-
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY2() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY2() );
-			
-			if( ! colors.empty() ) {
-				for( int i = 0; i < 4; ++i ) {
-					vertColors.push_back( colors[glyphIt-glyphMeasures.begin()] );
-				}
-			}
+SdfTextRef SdfText::AsyncResult::get()
+{
+	if( ! mResult ) {
+		mResult = mFuture.get();
+		mResult->mTextureAtlases->finishPages();
+	}
+	return mResult;
+}
 
-			indices.push_back( curIdx + 0 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 2 );
-			indices.push_back( curIdx + 2 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 3 );
-			curIdx += 4;
-		}
-		
-		if( curIdx == 0 ) {
-			continue;
+// =================================================================================================
+// SdfText drawing
+// =================================================================================================
+//! Returns the default shader for \a options, compiling it on first use
+static gl::GlslProgRef getDefaultSdfShader( const SdfText::DrawOptions &options, bool textureArray )
+{
+	const bool minimal = options.getUseMinimalShader();
+	gl::GlslProgRef &shader = textureArray 
+		? ( minimal ? sDefaultMinimalArrayShader : sDefaultArrayShader ) 
+		: ( minimal ? sDefaultMinimalShader : sDefaultShader );
+	if( ! shader ) {
+		const std::string header = std::string( "#version 150\n" ) + ( textureArray ? "#define SDF_TEXTURE_ARRAY\n" : "" );
+		try {
+			shader = gl::GlslProg::create( header + kSdfVertShader, header + kSdfFragSampler + ( minimal ? kSdfFragMinimalShader : kSdfFragShader ) );
 		}
-		
-		curTex->bind();
-		auto ctx = gl::context();
-		size_t dataSize = (verts.size() + texCoords.size()) * sizeof(float) + vertColors.size() * sizeof(ColorA8u);
-		gl::ScopedVao vaoScp( ctx->getDefaultVao() );
-		ctx->getDefaultVao()->replacementBindBegin();
-		VboRef defaultElementVbo = ctx->getDefaultElementVbo( indices.size() * sizeof(curIdx) );
-		VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( dataSize );
-
-		ScopedBuffer vboArrayScp( defaultArrayVbo );
-		ScopedBuffer vboElScp( defaultElementVbo );
-
-		size_t dataOffset = 0;
-		int posLoc = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
-		if( posLoc >= 0 ) {
-			enableVertexAttribArray( posLoc );
-			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-			defaultArrayVbo->bufferSubData( dataOffset, verts.size() * sizeof(float), verts.data() );
-			dataOffset += verts.size() * sizeof(float);
-		}
-		int texLoc = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
-		if( texLoc >= 0 ) {
-			enableVertexAttribArray( texLoc );
-			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataOffset );
-			defaultArrayVbo->bufferSubData( dataOffset, texCoords.size() * sizeof(float), texCoords.data() );
-			dataOffset += texCoords.size() * sizeof(float);
-		}
-		if( ! vertColors.empty() ) {
-			int colorLoc = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
-			if( colorLoc >= 0 ) {
-				enableVertexAttribArray( colorLoc );
-				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)dataOffset );
-				defaultArrayVbo->bufferSubData( dataOffset, vertColors.size() * sizeof(ColorA8u), vertColors.data() );
-				dataOffset += vertColors.size() * sizeof(ColorA8u);				
-			}
+		catch( const std::exception& e ) {
+			CI_LOG_E( ( minimal ? "sDefaultMinimalShader" : "sDefaultShader" ) << ( textureArray ? " (texture array)" : "" ) << " error: " << e.what() );
 		}
-
-		defaultElementVbo->bufferSubData( 0, indices.size() * sizeof(curIdx), indices.data() );
-		ctx->getDefaultVao()->replacementBindEnd();
-		gl::setDefaultShaderVars();
-		ctx->drawElements( GL_TRIANGLES, (GLsizei)indices.size(), indexType, 0 );
 	}
+	return shader;
 }
 
-void SdfText::drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const Rectf &clip, vec2 offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+//! Draws the quads of \a batch with \a shader and the textures bound by the caller
+static void drawGlyphQuadBatch( const GlyphQuadBatch &batch, const gl::GlslProgRef &shader )
 {
-	const auto& textures = mTextureAtlases->mTextures;
-	const auto& glyphMap = mTextureAtlases->mGlyphInfo;
-	const auto& sdfPadding = mTextureAtlases->mSdfPadding;
-	const auto& sdfBitmapSize = mTextureAtlases->mSdfBitmapSize;
-
-	if( textures.empty() ) {
-		return;
+	const GLenum indexType = GL_UNSIGNED_INT;
+	const auto& verts = batch.mVerts;
+	const auto& texCoords = batch.mTexCoords;
+	const auto& vertColors = batch.mColors;
+	const auto& indices = batch.mIndices;
+
+	auto ctx = gl::context();
+	size_t dataSize = (verts.size() + texCoords.size()) * sizeof(float) + vertColors.size() * sizeof(ColorA8u);
+	gl::ScopedVao vaoScp( ctx->getDefaultVao() );
+	ctx->getDefaultVao()->replacementBindBegin();
+	VboRef defaultElementVbo = ctx->getDefaultElementVbo( indices.size() * sizeof(uint32_t) );
+	VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( dataSize );
+
+	ScopedBuffer vboArrayScp( defaultArrayVbo );
+	ScopedBuffer vboElScp( defaultElementVbo );
+
+	size_t dataOffset = 0;
+	int posLoc = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
+	if( posLoc >= 0 ) {
+		enableVertexAttribArray( posLoc );
+		vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+		defaultArrayVbo->bufferSubData( dataOffset, verts.size() * sizeof(float), verts.data() );
+		dataOffset += verts.size() * sizeof(float);
+	}
+	int texLoc = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
+	if( texLoc >= 0 ) {
+		enableVertexAttribArray( texLoc );
+		vertexAttribPointer( texLoc, batch.mTexCoordSize, GL_FLOAT, GL_FALSE, 0, (void*)dataOffset );
+		defaultArrayVbo->bufferSubData( dataOffset, texCoords.size() * sizeof(float), texCoords.data() );
+		dataOffset += texCoords.size() * sizeof(float);
+	}
+	if( ! vertColors.empty() ) {
+		int colorLoc = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
+		if( colorLoc >= 0 ) {
+			enableVertexAttribArray( colorLoc );
+			vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)dataOffset );
+			defaultArrayVbo->bufferSubData( dataOffset, vertColors.size() * sizeof(ColorA8u), vertColors.data() );
+			dataOffset += vertColors.size() * sizeof(ColorA8u);				
+		}
 	}
 
-	if( ! colors.empty() ) {
-		assert( glyphMeasures.size() == colors.size() );
+	defaultElementVbo->bufferSubData( 0, indices.size() * sizeof(uint32_t), indices.data() );
+	ctx->getDefaultVao()->replacementBindEnd();
+	gl::setDefaultShaderVars();
+	ctx->drawElements( GL_TRIANGLES, (GLsizei)indices.size(), indexType, 0 );
+}
+
+void SdfText::drawGlyphQuadBatches( const std::vector<GlyphQuadBatch> &batches, const DrawOptions &options )
+{
+	// Nothing to draw, a dynamic atlas may not even have pages yet
+	if( std::all_of( std::begin( batches ), std::end( batches ), []( const GlyphQuadBatch& batch ) { return batch.empty(); } ) ) {
+		return;
 	}
 
 	auto shader = options.getGlslProg();
 	if( ! shader ) {
-		if( options.getUseMinimalShader() ) {
-			if( ! sDefaultMinimalShader ) {
-				try {
-					sDefaultMinimalShader = gl::GlslProg::create( kSdfVertShader, kSdfFragMinimalShader );
-				}
-				catch( const std::exception& e ) {
-					CI_LOG_E( "sDefaultMinimalShader error: " << e.what() );
-				}
-			}
-			shader = sDefaultMinimalShader;
-		}
-		else {
-			if( ! sDefaultShader ) {
-				try {
-					sDefaultShader = gl::GlslProg::create( kSdfVertShader, kSdfFragShader );
-				}
-				catch( const std::exception& e ) {
-					CI_LOG_E( "sDefaultShader error: " << e.what() );
-				}
-			}
-			shader = sDefaultShader;
-		}
+		shader = getDefaultSdfShader( options, mTextureAtlases->isTextureArray() );
 	}
-	ScopedTextureBind texBindScp( textures[0] );
 	ScopedGlslProg glslScp( shader );
 
 	if( ! options.getGlslProg() ) {
@@ -1457,168 +4017,202 @@ void SdfText::drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, con
 		shader->uniform( "uGamma", options.getGamma() );
 	}
 
-	const vec2 fontRenderScale = vec2( mFont.getSize() ) / ( 32.0f * mTextureAtlases->mSdfScale );
-	const vec2 fontOriginScale = vec2( mFont.getSize() ) / 32.0f;
+#if ! defined( CINDER_GL_ES_2 )
+	if( mTextureAtlases->isTextureArray() ) {
+		ScopedTextureBind texBindScp( mTextureAtlases->mTextureArray );
+		if( ! batches[0].empty() ) {
+			drawGlyphQuadBatch( batches[0], shader );
+		}
+		return;
+	}
+#endif
+
+	const auto& textures = mTextureAtlases->mTextures;
+	ScopedTextureBind texBindScp( textures[0] );
+	for( size_t texIdx = 0; texIdx < batches.size(); ++texIdx ) {
+		if( batches[texIdx].empty() ) {
+			continue;
+		}
+		textures[texIdx]->bind();
+		drawGlyphQuadBatch( batches[texIdx], shader );
+	}
+}
 
-	const float scale = options.getScale();
-	for( size_t texIdx = 0; texIdx < textures.size(); ++texIdx ) {
-		std::vector<float> verts, texCoords;
-		std::vector<ColorA8u> vertColors;
-		const gl::TextureRef &curTex = textures[texIdx];
+void SdfText::drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const vec2 &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+{
+	const auto& sdfPadding = mTextureAtlases->mSdfPadding;
+	const bool textureArray = mTextureAtlases->isTextureArray();
 
-		std::vector<uint32_t> indices;
-		uint32_t curIdx = 0;
-		GLenum indexType = GL_UNSIGNED_INT;
+	// Pages built on worker threads are uploaded before any glyph is looked up, since only glyphs of uploaded pages are drawn
+	mTextureAtlases->finishPages();
+	if( ( 0 == mTextureAtlases->getPageCapacity() ) && ( ! mTextureAtlases->isUnicodeBlocks() ) ) {
+		return;
+	}
 
-		if( options.getPixelSnap() ) {
-			offset = vec2( floor( offset.x ), floor( offset.y ) );
-		}
+	if( ! colors.empty() ) {
+		assert( glyphMeasures.size() == colors.size() );
+	}
 
-		for( std::vector<std::pair<Font::Glyph,vec2> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
-			SdfText::TextureAtlas::GlyphInfoMap::const_iterator glyphInfoIt = glyphMap.find( glyphIt->first );
-			if( glyphInfoIt == glyphMap.end() ) {
-				continue;
-			}
-				
-			const auto &glyphInfo = glyphInfoIt->second;
-			if( glyphInfo.mTextureIndex != texIdx ) {
-				continue;
-			}
+	vec2 baseline = baselineIn;
+	if( options.getPixelSnap() ) {
+		baseline = vec2( floor( baseline.x ), floor( baseline.y ) );
+	}
 
-			Rectf srcTexCoords = curTex->getAreaTexCoords( glyphInfo.mTexCoords );
-			Rectf destRect( glyphInfo.mTexCoords );
-			destRect.scale( fontRenderScale );
-			destRect -= destRect.getUpperLeft();
-			destRect.scale( scale );
-			destRect += glyphIt->second * scale;
-			destRect += vec2( offset.x, offset.y );
-			vec2 originOffset = fontOriginScale * glyphInfo.mOriginOffset;
-			destRect += vec2( floor( originOffset.x + 0.5f ), floor( -originOffset.y ) ) * scale;
-			destRect += fontRenderScale * vec2( -sdfPadding.x, -sdfPadding.y );
-			if( options.getPixelSnap() ) {
-				destRect -= vec2( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );	
-			}
+	const float fontSize = getSizeScale( mFont, options ) * mFont.getSize();
+	const vec2 fontOriginScale = vec2( fontSize ) / 32.0f;
 
-			// clip
-			Rectf clipped( destRect );
-			if( options.getClipHorizontal() ) {
-				clipped.x1 = std::max( destRect.x1, clip.x1 );
-				clipped.x2 = std::min( destRect.x2, clip.x2 );
-			}
-			if( options.getClipVertical() ) {
-				clipped.y1 = std::max( destRect.y1, clip.y1 );
-				clipped.y2 = std::min( destRect.y2, clip.y2 );
-			}
+	const float scale = options.getScale();
+
+	// Assign each glyph to its page in a single pass, a dynamic atlas renders missing glyphs along the way
+	mTextureAtlases->beginUse();
+	std::vector<GlyphQuadBatch> batches = GlyphQuadBatch::createBatches( mTextureAtlases->getPageCapacity(), textureArray );
+	for( std::vector<std::pair<SdfText::Font::Glyph,vec2> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		const SdfText::TextureAtlas::GlyphInfo *glyphInfoPtr = mTextureAtlases->acquireGlyph( mFaceSlot, glyphIt->first );
+		if( nullptr == glyphInfoPtr ) {
+			continue;
+		}
 			
-			if( clipped.x1 >= clipped.x2 || clipped.y1 >= clipped.y2 ) {
-				continue;
-			}
+		const auto &glyphInfo = *glyphInfoPtr;
+		const auto &originOffset = glyphInfo.mOriginOffset;
+		const auto &sdfScale = glyphInfo.mSdfScale;
+		const vec2 fontRenderScale = vec2( fontSize ) / ( 32.0f * sdfScale );
+
+		Rectf srcTexCoords = mTextureAtlases->getTexCoords( glyphInfo.mTexCoords );
+		Rectf destRect = Rectf( glyphInfo.mTexCoords );
+		destRect.scale( scale );
+		destRect -= destRect.getUpperLeft();
+		vec2 offset = vec2( 0, -( destRect.getHeight() ) );
+		// Reverse the transformation applied during SDF generation
+		float tx = sdfPadding.x;
+		float ty = std::fabs( originOffset.y ) + sdfPadding.y;
+		offset += scale * sdfScale * vec2( -tx, ty );
+		// Use origin scale for horizontal offset
+		offset += scale * fontOriginScale * vec2( originOffset.x, 0.0f );
+		destRect += offset;
+		destRect.scale( fontRenderScale );
+
+		destRect += glyphIt->second * scale;
+		destRect += baseline;
+
+		addGlyphQuad( &batches, textureArray, glyphInfo.mTextureIndex, destRect, srcTexCoords, colors.empty() ? nullptr : &colors[glyphIt-glyphMeasures.begin()] );
+	}
 
-			verts.push_back( clipped.getX2() ); verts.push_back( clipped.getY1() );
-			verts.push_back( clipped.getX1() ); verts.push_back( clipped.getY1() );
-			verts.push_back( clipped.getX2() ); verts.push_back( clipped.getY2() );
-			verts.push_back( clipped.getX1() ); verts.push_back( clipped.getY2() );
-
-			vec2 coordScale = vec2( srcTexCoords.getWidth() / destRect.getWidth(), srcTexCoords.getHeight() / destRect.getHeight() );
-			srcTexCoords.x1 = srcTexCoords.x1 + ( clipped.x1 - destRect.x1 ) * coordScale.x;
-			srcTexCoords.x2 = srcTexCoords.x1 + ( clipped.x2 - clipped.x1  ) * coordScale.x;
-			srcTexCoords.y1 = srcTexCoords.y1 + ( clipped.y1 - destRect.y1 ) * coordScale.y;
-			srcTexCoords.y2 = srcTexCoords.y1 + ( clipped.y2 - clipped.y1  ) * coordScale.y;
-
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY1() );
-			texCoords.push_back( srcTexCoords.getX2() ); texCoords.push_back( srcTexCoords.getY2() );
-			texCoords.push_back( srcTexCoords.getX1() ); texCoords.push_back( srcTexCoords.getY2() );
-
-			if( ! colors.empty() ) {
-				for( int i = 0; i < 4; ++i ) {
-					vertColors.push_back( colors[glyphIt-glyphMeasures.begin()] );
-				}
-			}
+	drawGlyphQuadBatches( batches, options );
+}
+
+void SdfText::drawGlyphs( const SdfText::Font::GlyphMeasures &glyphMeasures, const Rectf &clip, vec2 offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
+{
+	const auto& sdfPadding = mTextureAtlases->mSdfPadding;
+	const bool textureArray = mTextureAtlases->isTextureArray();
+
+	// Pages built on worker threads are uploaded before any glyph is looked up, since only glyphs of uploaded pages are drawn
+	mTextureAtlases->finishPages();
+	if( ( 0 == mTextureAtlases->getPageCapacity() ) && ( ! mTextureAtlases->isUnicodeBlocks() ) ) {
+		return;
+	}
+
+	if( ! colors.empty() ) {
+		assert( glyphMeasures.size() == colors.size() );
+	}
+
+	if( options.getPixelSnap() ) {
+		offset = vec2( floor( offset.x ), floor( offset.y ) );
+	}
+
+	const float fontSize = getSizeScale( mFont, options ) * mFont.getSize();
+	const vec2 fontOriginScale = vec2( fontSize ) / 32.0f;
+
+	const float scale = options.getScale();
+
+	// Assign each glyph to its page in a single pass, a dynamic atlas renders missing glyphs along the way
+	mTextureAtlases->beginUse();
+	std::vector<GlyphQuadBatch> batches = GlyphQuadBatch::createBatches( mTextureAtlases->getPageCapacity(), textureArray );
+	for( std::vector<std::pair<Font::Glyph,vec2> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		const SdfText::TextureAtlas::GlyphInfo *glyphInfoPtr = mTextureAtlases->acquireGlyph( mFaceSlot, glyphIt->first );
+		if( nullptr == glyphInfoPtr ) {
+			continue;
+		}
 			
-			indices.push_back( curIdx + 0 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 2 );
-			indices.push_back( curIdx + 2 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 3 );
-			curIdx += 4;
+		const auto &glyphInfo = *glyphInfoPtr;
+		const vec2 fontRenderScale = vec2( fontSize ) / ( 32.0f * glyphInfo.mSdfScale );
+
+		Rectf srcTexCoords = mTextureAtlases->getTexCoords( glyphInfo.mTexCoords );
+		Rectf destRect( glyphInfo.mTexCoords );
+		destRect.scale( fontRenderScale );
+		destRect -= destRect.getUpperLeft();
+		destRect.scale( scale );
+		destRect += glyphIt->second * scale;
+		destRect += vec2( offset.x, offset.y );
+		vec2 originOffset = fontOriginScale * glyphInfo.mOriginOffset;
+		destRect += vec2( floor( originOffset.x + 0.5f ), floor( -originOffset.y ) ) * scale;
+		destRect += fontRenderScale * vec2( -sdfPadding.x, -sdfPadding.y );
+		if( options.getPixelSnap() ) {
+			destRect -= vec2( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );	
 		}
-		
-		if( curIdx == 0 ) {
-			continue;
+
+		// clip
+		Rectf clipped( destRect );
+		if( options.getClipHorizontal() ) {
+			clipped.x1 = std::max( destRect.x1, clip.x1 );
+			clipped.x2 = std::min( destRect.x2, clip.x2 );
+		}
+		if( options.getClipVertical() ) {
+			clipped.y1 = std::max( destRect.y1, clip.y1 );
+			clipped.y2 = std::min( destRect.y2, clip.y2 );
 		}
 		
-		curTex->bind();
-		auto ctx = gl::context();
-		size_t dataSize = (verts.size() + texCoords.size()) * sizeof(float) + vertColors.size() * sizeof(ColorA8u);
-		gl::ScopedVao vaoScp( ctx->getDefaultVao() );
-		ctx->getDefaultVao()->replacementBindBegin();
-		VboRef defaultElementVbo = ctx->getDefaultElementVbo( indices.size() * sizeof(curIdx) );
-		VboRef defaultArrayVbo = ctx->getDefaultArrayVbo( dataSize );
-
-		ScopedBuffer vboArrayScp( defaultArrayVbo );
-		ScopedBuffer vboElScp( defaultElementVbo );
-
-		size_t dataOffset = 0;
-		int posLoc = shader->getAttribSemanticLocation( geom::Attrib::POSITION );
-		if( posLoc >= 0 ) {
-			enableVertexAttribArray( posLoc );
-			vertexAttribPointer( posLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-			defaultArrayVbo->bufferSubData( dataOffset, verts.size() * sizeof(float), verts.data() );
-			dataOffset += verts.size() * sizeof(float);
-		}
-		int texLoc = shader->getAttribSemanticLocation( geom::Attrib::TEX_COORD_0 );
-		if( texLoc >= 0 ) {
-			enableVertexAttribArray( texLoc );
-			vertexAttribPointer( texLoc, 2, GL_FLOAT, GL_FALSE, 0, (void*)dataOffset );
-			defaultArrayVbo->bufferSubData( dataOffset, texCoords.size() * sizeof(float), texCoords.data() );
-			dataOffset += texCoords.size() * sizeof(float);
-		}
-		if( ! vertColors.empty() ) {
-			int colorLoc = shader->getAttribSemanticLocation( geom::Attrib::COLOR );
-			if( colorLoc >= 0 ) {
-				enableVertexAttribArray( colorLoc );
-				vertexAttribPointer( colorLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)dataOffset );
-				defaultArrayVbo->bufferSubData( dataOffset, vertColors.size() * sizeof(ColorA8u), vertColors.data() );
-				dataOffset += vertColors.size() * sizeof(ColorA8u);				
-			}
+		if( clipped.x1 >= clipped.x2 || clipped.y1 >= clipped.y2 ) {
+			continue;
 		}
 
-		defaultElementVbo->bufferSubData( 0, indices.size() * sizeof(curIdx), indices.data() );
-		ctx->getDefaultVao()->replacementBindEnd();
-		gl::setDefaultShaderVars();
-		ctx->drawElements( GL_TRIANGLES, (GLsizei)indices.size(), indexType, 0 );
+		vec2 coordScale = vec2( srcTexCoords.getWidth() / destRect.getWidth(), srcTexCoords.getHeight() / destRect.getHeight() );
+		srcTexCoords.x1 = srcTexCoords.x1 + ( clipped.x1 - destRect.x1 ) * coordScale.x;
+		srcTexCoords.x2 = srcTexCoords.x1 + ( clipped.x2 - clipped.x1  ) * coordScale.x;
+		srcTexCoords.y1 = srcTexCoords.y1 + ( clipped.y1 - destRect.y1 ) * coordScale.y;
+		srcTexCoords.y2 = srcTexCoords.y1 + ( clipped.y2 - clipped.y1  ) * coordScale.y;
+
+		addGlyphQuad( &batches, textureArray, glyphInfo.mTextureIndex, clipped, srcTexCoords, colors.empty() ? nullptr : &colors[glyphIt-glyphMeasures.begin()] );
 	}
+
+	drawGlyphQuadBatches( batches, options );
+}
+
+SdfText::Font::GlyphMeasures SdfText::measureGlyphs( const std::string &str, const ivec2 &boxSize, const DrawOptions &options ) const
+{
+	// The face lock also guards mCachedGlyphMetrics, which measuring on other threads fills in
+	FaceLock faceLock = mFont.mData->lock();
+	cacheGlyphMetrics( str );
+	SdfTextBox tbox = SdfTextBox( mFont ).text( str ).size( boxSize ).ligate( options.getLigate() );
+	return tbox.measureGlyphs( mCachedGlyphMetrics, options );
 }
 
 void SdfText::drawString( const std::string &str, const vec2 &baseline, const DrawOptions &options )
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( SdfTextBox::GROW, SdfTextBox::GROW ).ligate( options.getLigate() );
-	SdfText::Font::GlyphMeasures glyphMeasures = tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	SdfText::Font::GlyphMeasures glyphMeasures = measureGlyphs( str, ivec2( SdfTextBox::GROW, SdfTextBox::GROW ), options );
 	drawGlyphs( glyphMeasures, baseline, options );
 }
 
 void SdfText::drawString( const std::string &str, const Rectf &fitRect, const vec2 &offset, const DrawOptions &options )
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( SdfTextBox::GROW, fitRect.getHeight() ).ligate( options.getLigate() );
-	SdfText::Font::GlyphMeasures glyphMeasures = tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	SdfText::Font::GlyphMeasures glyphMeasures = measureGlyphs( str, ivec2( SdfTextBox::GROW, fitRect.getHeight() ), options );
 	drawGlyphs( glyphMeasures, fitRect, fitRect.getUpperLeft() + offset, options );	
 }
 
 void SdfText::drawStringWrapped( const std::string &str, const Rectf &fitRect, const vec2 &offset, const DrawOptions &options )
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( fitRect.getWidth(), fitRect.getHeight() ).ligate( options.getLigate() );
-	SdfText::Font::GlyphMeasures glyphMeasures = tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	SdfText::Font::GlyphMeasures glyphMeasures = measureGlyphs( str, ivec2( fitRect.getWidth(), fitRect.getHeight() ), options );
 	drawGlyphs( glyphMeasures, fitRect.getUpperLeft() + offset, options );
 }
 
 vec2 SdfText::measureString( const std::string &str, const DrawOptions &options ) const
 {
-	const SdfText::TextureAtlas::GlyphInfoMap& mGlyphMap = mTextureAtlases->mGlyphInfo;
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( SdfTextBox::GROW, SdfTextBox::GROW ).ligate( options.getLigate() );
-	SdfText::Font::GlyphMeasures glyphMeasures = tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	SdfText::Font::GlyphMeasures glyphMeasures = measureGlyphs( str, ivec2( SdfTextBox::GROW, SdfTextBox::GROW ), options );
 	if( ! glyphMeasures.empty() ) {
 		vec2 result = glyphMeasures.back().second;
-		SdfText::TextureAtlas::GlyphInfoMap::const_iterator glyphInfoIt = mGlyphMap.find( glyphMeasures.back().first );
-		if( glyphInfoIt != mGlyphMap.end() ) {
-			result += glyphInfoIt->second.mOriginOffset + vec2( glyphInfoIt->second.mTexCoords.getSize() );
+		SdfText::TextureAtlas::GlyphInfo glyphInfo;
+		// The cell size is known before the page of the glyph is generated
+		if( mTextureAtlases->findGlyphInfo( SdfText::TextureAtlas::makeGlyphKey( mFaceSlot, glyphMeasures.back().first ), &glyphInfo, false ) ) {
+			result += getSizeScale( mFont, options ) * ( glyphInfo.mOriginOffset + vec2( glyphInfo.mTexCoords.getSize() ) );
 		}
 		return result;
 	}
@@ -1629,20 +4223,17 @@ vec2 SdfText::measureString( const std::string &str, const DrawOptions &options
 
 std::vector<std::pair<SdfText::Font::Glyph, vec2>> SdfText::getGlyphPlacements( const std::string &str, const DrawOptions &options ) const
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( SdfTextBox::GROW, SdfTextBox::GROW ).ligate( options.getLigate() );
-	return tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	return measureGlyphs( str, ivec2( SdfTextBox::GROW, SdfTextBox::GROW ), options );
 }
 
 std::vector<std::pair<SdfText::Font::Glyph, vec2>> SdfText::getGlyphPlacements( const std::string &str, const Rectf &fitRect, const DrawOptions &options ) const
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( SdfTextBox::GROW, fitRect.getHeight() ).ligate( options.getLigate() );
-	return tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	return measureGlyphs( str, ivec2( SdfTextBox::GROW, fitRect.getHeight() ), options );
 }
 
 std::vector<std::pair<SdfText::Font::Glyph, vec2>> SdfText::getGlyphPlacementsWrapped( const std::string &str, const Rectf &fitRect, const DrawOptions &options ) const
 {
-	SdfTextBox tbox = SdfTextBox().font( mFont ).text( str ).size( fitRect.getWidth(), fitRect.getHeight() ).ligate( options.getLigate() );
-	return tbox.measureGlyphs( mCachedGlyphMetrics, options );
+	return measureGlyphs( str, ivec2( fitRect.getWidth(), fitRect.getHeight() ), options );
 }
 
 std::string SdfText::defaultChars() 
@@ -1652,10 +4243,40 @@ std::string SdfText::defaultChars()
 
 void SdfText::cacheGlyphMetrics()
 {
-	FT_Face face = mFont.getFace();
-	for( const auto it : mTextureAtlases->mCharToGlyph ) {
+	SdfText::Font::LockedFace face = mFont.getFace();
+	for( const auto it : mTextureAtlases->mFaces[mFaceSlot].mCharToGlyph ) {
 		SdfText::Font::Glyph glyphIndex = it.second;
-		FT_Load_Glyph( face, glyphIndex, FT_LOAD_DEFAULT );
+		FT_Load_Glyph( face.get(), glyphIndex, FT_LOAD_DEFAULT );
+		FT_GlyphSlot slot = face->glyph;
+		SdfText::Font::GlyphMetrics glyphMetrics;
+		glyphMetrics.advance = vec2( slot->linearHoriAdvance , slot->linearVertAdvance ) / 65536.0f;
+		mCachedGlyphMetrics[glyphIndex] = glyphMetrics;
+	}
+}
+
+void SdfText::cacheGlyphMetrics( const std::string &utf8Chars ) const
+{
+	// Static atlases cached the metrics of all their glyphs up front
+	if( ! mTextureAtlases->isLoadedOnDemand() ) {
+		return;
+	}
+
+	std::vector<SdfText::Font::Glyph> glyphs;
+	SdfText::Font::LockedFace face = mFont.getFace();
+	for( const auto& ch : ci::toUtf32( utf8Chars ) ) {
+		glyphs.push_back( FT_Get_Char_Index( face.get(), static_cast<FT_ULong>( ch ) ) );
+	}
+	cacheGlyphMetrics( glyphs );
+}
+
+void SdfText::cacheGlyphMetrics( const std::vector<SdfText::Font::Glyph> &glyphs ) const
+{
+	SdfText::Font::LockedFace face = mFont.getFace();
+	for( const auto& glyphIndex : glyphs ) {
+		if( mCachedGlyphMetrics.end() != mCachedGlyphMetrics.find( glyphIndex ) ) {
+			continue;
+		}
+		FT_Load_Glyph( face.get(), glyphIndex, FT_LOAD_DEFAULT );
 		FT_GlyphSlot slot = face->glyph;
 		SdfText::Font::GlyphMetrics glyphMetrics;
 		glyphMetrics.advance = vec2( slot->linearHoriAdvance , slot->linearVertAdvance ) / 65536.0f;
@@ -1663,14 +4284,99 @@ void SdfText::cacheGlyphMetrics()
 	}
 }
 
+SdfText::GlyphResidencyStats SdfText::getGlyphResidencyStats() const
+{
+	return mTextureAtlases->getGlyphResidencyStats();
+}
+
+bool SdfText::compactAtlas( size_t maxCellMoves, uint32_t maxIdleDraws )
+{
+	return mTextureAtlases->compact( maxCellMoves, maxIdleDraws );
+}
+
+SdfText::AtlasLayout SdfText::getAtlasLayout() const
+{
+	return mTextureAtlases->getAtlasLayout();
+}
+
+SdfText::AtlasStats SdfText::getAtlasStats() const
+{
+	return mTextureAtlases->getAtlasStats();
+}
+
+size_t SdfText::prepareGlyphs( const std::vector<SdfText::Font::Glyph> &glyphs )
+{
+	cacheGlyphMetrics( glyphs );
+
+	// All of them are part of the same use, so none evicts another
+	mTextureAtlases->beginUse();
+	size_t result = 0;
+	for( const auto& glyph : glyphs ) {
+		if( nullptr != mTextureAtlases->acquireGlyph( mFaceSlot, glyph ) ) {
+			++result;
+		}
+	}
+	return result;
+}
+
 uint32_t SdfText::getNumTextures() const
 {
+	mTextureAtlases->finishPages();
 	return static_cast<uint32_t>( mTextureAtlases->mTextures.size() );
 }
 
 const gl::TextureRef& SdfText::getTexture(uint32_t n) const
 {
+	mTextureAtlases->finishPages();
 	return mTextureAtlases->mTextures[static_cast<size_t>( n )];
 }
 
+#if ! defined( CINDER_GL_ES_2 )
+const gl::Texture3dRef& SdfText::getTextureArray() const
+{
+	mTextureAtlases->finishPages();
+	return mTextureAtlases->mTextureArray;
+}
+#endif
+
+SdfText::AtlasCacheStats SdfText::getAtlasCacheStats()
+{
+	return SdfTextManager::instance()->getAtlasCacheStats();
+}
+
+std::vector<SdfText::AtlasStats> SdfText::getCachedAtlasStats()
+{
+	return SdfTextManager::instance()->getCachedAtlasStats();
+}
+
+void SdfText::setAtlasCacheBudget( size_t bytes )
+{
+	SdfTextManager::instance()->setAtlasCacheBudget( bytes );
+}
+
+size_t SdfText::getAtlasCacheBudget()
+{
+	return SdfTextManager::instance()->getAtlasCacheBudget();
+}
+
+void SdfText::purgeUnusedAtlases()
+{
+	SdfTextManager::instance()->purgeUnusedAtlases();
+}
+
+void SdfText::shutdown()
+{
+	SdfTextManager::destroyInstance();
+}
+
+void SdfText::setAtlasDiskCacheDirectory( const fs::path &directory )
+{
+	SdfTextManager::instance()->setAtlasDiskCacheDirectory( directory );
+}
+
+fs::path SdfText::getAtlasDiskCacheDirectory()
+{
+	return SdfTextManager::instance()->getAtlasDiskCacheDirectory();
+}
+
 }} // namespace cinder::gl
\ No newline at end of file
@@ -0,0 +1,632 @@
+/*
+Copyright 2016 Google Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+Copyright (c) 2016, The Cinder Project, All rights reserved.
+This code is intended for use with the Cinder C++ library: http://libcinder.org
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this list of conditions and
+the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+the following disclaimer in the documentation and/or other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SdfTextInternal.h"
+
+#include "cinder/Log.h"
+
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <boost/algorithm/string.hpp>
+
+namespace cinder { namespace gl { namespace detail {
+
+void writeBinaryString( std::ostream &os, const std::string &value )
+{
+	writeBinary( os, static_cast<uint32_t>( value.size() ) );
+	os.write( value.data(), value.size() );
+}
+
+bool hasRemainingBytes( std::istream &is, uint64_t numBytes )
+{
+	const std::streampos pos = is.tellg();
+	if( ( std::streampos( -1 ) == pos ) || ( ! is.seekg( 0, std::ios::end ) ) ) {
+		return false;
+	}
+	const std::streampos end = is.tellg();
+	is.seekg( pos );
+	return is.good() && ( end >= pos ) && ( static_cast<uint64_t>( end - pos ) >= numBytes );
+}
+
+bool readBinaryString( std::istream &is, std::string *value )
+{
+	uint32_t size = 0;
+	if( ! ( readBinary( is, &size ) && hasRemainingBytes( is, size ) ) ) {
+		return false;
+	}
+	value->resize( size );
+	is.read( &( *value )[0], size );
+	return is.good();
+}
+
+// =================================================================================================
+// AtlasCacheKey
+// =================================================================================================
+void AtlasCacheKey::write( std::ostream &os ) const
+{
+	writeBinary( os, static_cast<uint32_t>( mFaces.size() ) );
+	for( const auto& face : mFaces ) {
+		writeBinaryString( os, face.mFamilyName );
+		writeBinaryString( os, face.mStyleName );
+		writeBinary( os, face.mNumGlyphs );
+		writeBinary( os, face.mUnitsPerEm );
+		writeBinary( os, face.mBBoxMin );
+		writeBinary( os, face.mBBoxMax );
+		writeBinary( os, static_cast<uint32_t>( face.mGlyphIndices.size() ) );
+		os.write( reinterpret_cast<const char *>( face.mGlyphIndices.data() ), face.mGlyphIndices.size() * sizeof( uint32_t ) );
+	}
+	writeBinary( os, mTextureSize );
+	writeBinary( os, static_cast<uint8_t>( mAutoTextureSize ? 1 : 0 ) );
+	writeBinary( os, mSdfScale );
+	writeBinary( os, mSdfPadding );
+	writeBinary( os, mSdfRange );
+	writeBinary( os, mSdfAngle );
+	writeBinary( os, mSdfTileSpacing );
+	writeBinary( os, static_cast<uint8_t>( mTextureArray ? 1 : 0 ) );
+	writeBinary( os, static_cast<uint8_t>( mAdaptiveSdfScale ? 1 : 0 ) );
+	writeBinary( os, mSdfScaleRange );
+	writeBinary( os, static_cast<uint8_t>( mDynamic ? 1 : 0 ) );
+	writeBinary( os, mMaxPages );
+	writeBinary( os, mPyramidSdfScale );
+	writeBinary( os, static_cast<uint8_t>( mUnicodeBlocks ? 1 : 0 ) );
+}
+
+bool AtlasCacheKey::read( std::istream &is )
+{
+	uint32_t numFaces = 0;
+	if( ! ( readBinary( is, &numFaces ) && hasRemainingBytes( is, static_cast<uint64_t>( numFaces ) * 2 * sizeof( uint32_t ) ) ) ) {
+		return false;
+	}
+	mFaces.resize( numFaces );
+	for( auto& face : mFaces ) {
+		uint32_t numGlyphs = 0;
+		if( ! ( readBinaryString( is, &face.mFamilyName ) && 
+			    readBinaryString( is, &face.mStyleName ) && 
+			    readBinary( is, &face.mNumGlyphs ) &&
+			    readBinary( is, &face.mUnitsPerEm ) &&
+			    readBinary( is, &face.mBBoxMin ) &&
+			    readBinary( is, &face.mBBoxMax ) &&
+			    readBinary( is, &numGlyphs ) &&
+			    hasRemainingBytes( is, static_cast<uint64_t>( numGlyphs ) * sizeof( uint32_t ) ) ) ) {
+			return false;
+		}
+		face.mGlyphIndices.resize( numGlyphs );
+		is.read( reinterpret_cast<char *>( face.mGlyphIndices.data() ), numGlyphs * sizeof( uint32_t ) );
+		if( ! is.good() ) {
+			return false;
+		}
+	}
+	uint8_t autoTextureSize = 0;
+	uint8_t textureArray = 0;
+	uint8_t adaptiveSdfScale = 0;
+	uint8_t dynamic = 0;
+	uint8_t unicodeBlocks = 0;
+	bool result = readBinary( is, &mTextureSize ) &&
+				  readBinary( is, &autoTextureSize ) &&
+				  readBinary( is, &mSdfScale ) &&
+				  readBinary( is, &mSdfPadding ) &&
+				  readBinary( is, &mSdfRange ) &&
+				  readBinary( is, &mSdfAngle ) &&
+				  readBinary( is, &mSdfTileSpacing ) &&
+				  readBinary( is, &textureArray ) &&
+				  readBinary( is, &adaptiveSdfScale ) &&
+				  readBinary( is, &mSdfScaleRange ) &&
+				  readBinary( is, &dynamic ) &&
+				  readBinary( is, &mMaxPages ) &&
+				  readBinary( is, &mPyramidSdfScale ) &&
+				  readBinary( is, &unicodeBlocks );
+	mAutoTextureSize = ( 0 != autoTextureSize );
+	mTextureArray = ( 0 != textureArray );
+	mAdaptiveSdfScale = ( 0 != adaptiveSdfScale );
+	mDynamic = ( 0 != dynamic );
+	mUnicodeBlocks = ( 0 != unicodeBlocks );
+	return result;
+}
+
+// =================================================================================================
+// AtlasPageCodec
+// =================================================================================================
+AtlasPageCodec::Page AtlasPageCodec::encode( const Surface8u &surface )
+{
+	Page result;
+	result.mSize = surface.getSize();
+
+	const size_t width = static_cast<size_t>( surface.getWidth() );
+	const size_t pixelInc = surface.getPixelInc();
+	std::vector<uint8_t> deltas( 3 * width );
+	auto sameDelta = [&deltas]( size_t a, size_t b ) -> bool {
+		return ( deltas[3*a + 0] == deltas[3*b + 0] ) && ( deltas[3*a + 1] == deltas[3*b + 1] ) && ( deltas[3*a + 2] == deltas[3*b + 2] );
+	};
+
+	for( int32_t y = 0; y < surface.getHeight(); ++y ) {
+		// Delta code the row
+		const uint8_t *src = surface.getData() + y * surface.getRowBytes();
+		uint8_t prev[3] = { 0, 0, 0 };
+		for( size_t x = 0; x < width; ++x, src += pixelInc ) {
+			for( size_t c = 0; c < 3; ++c ) {
+				deltas[3*x + c] = static_cast<uint8_t>( src[c] - prev[c] );
+				prev[c] = src[c];
+			}
+		}
+
+		// Run-length encode the deltas
+		size_t x = 0;
+		while( x < width ) {
+			size_t run = 1;
+			while( ( x + run < width ) && ( run < kMaxRun ) && sameDelta( x, x + run ) ) {
+				++run;
+			}
+
+			if( run > 1 ) {
+				result.mData.push_back( static_cast<uint8_t>( 0x80 | ( run - 1 ) ) );
+				result.mData.insert( result.mData.end(), &deltas[3*x], &deltas[3*x] + 3 );
+				x += run;
+				continue;
+			}
+
+			// Literals until the next run starts
+			size_t start = x++;
+			while( ( x < width ) && ( x - start < kMaxRun ) && ( ! ( ( x + 1 < width ) && sameDelta( x, x + 1 ) ) ) ) {
+				++x;
+			}
+			result.mData.push_back( static_cast<uint8_t>( x - start - 1 ) );
+			result.mData.insert( result.mData.end(), &deltas[3*start], &deltas[3*x] );
+		}
+	}
+
+	return result;
+}
+
+bool AtlasPageCodec::decode( const Page &page, Surface8u *surface )
+{
+	if( ( nullptr == surface ) || ( surface->getSize() != page.mSize ) ) {
+		return false;
+	}
+
+	const uint8_t *src = page.mData.data();
+	const uint8_t *srcEnd = src + page.mData.size();
+	const size_t width = static_cast<size_t>( page.mSize.x );
+	const size_t pixelInc = surface->getPixelInc();
+	for( int32_t y = 0; y < page.mSize.y; ++y ) {
+		uint8_t *dst = surface->getData() + y * surface->getRowBytes();
+		uint8_t prev[3] = { 0, 0, 0 };
+		size_t x = 0;
+		while( x < width ) {
+			if( src >= srcEnd ) {
+				return false;
+			}
+
+			const uint8_t token = *src++;
+			const bool isRun = ( 0 != ( token & 0x80 ) );
+			const size_t count = static_cast<size_t>( token & 0x7F ) + 1;
+			const size_t numDeltaBytes = isRun ? 3 : 3 * count;
+			if( ( x + count > width ) || ( static_cast<size_t>( srcEnd - src ) < numDeltaBytes ) ) {
+				return false;
+			}
+
+			for( size_t i = 0; i < count; ++i, dst += pixelInc ) {
+				const uint8_t *delta = isRun ? src : ( src + 3 * i );
+				prev[0] = static_cast<uint8_t>( prev[0] + delta[0] );
+				prev[1] = static_cast<uint8_t>( prev[1] + delta[1] );
+				prev[2] = static_cast<uint8_t>( prev[2] + delta[2] );
+				dst[0] = prev[0];
+				dst[1] = prev[1];
+				dst[2] = prev[2];
+			}
+			src += numDeltaBytes;
+			x += count;
+		}
+	}
+
+	return true;
+}
+
+// =================================================================================================
+// Atlas layout
+// =================================================================================================
+std::vector<std::vector<RenderGlyph>> packGrid( const std::vector<RenderGlyph> &glyphs, const ivec2 &cellSize, const ivec2 &textureSize, const ivec2 &tileSpacing )
+{
+	std::vector<std::vector<RenderGlyph>> result;
+	if( glyphs.empty() ) {
+		return result;
+	}
+
+	const ivec2 cellStride = cellSize + tileSpacing;
+	const size_t numColumns = ( ( cellStride.x > 0 ) && ( cellSize.x <= textureSize.x ) ) ? static_cast<size_t>( textureSize.x / cellStride.x ) : 0;
+	const size_t numRows    = ( ( cellStride.y > 0 ) && ( cellSize.y <= textureSize.y ) ) ? static_cast<size_t>( textureSize.y / cellStride.y ) : 0;
+	const size_t numCellsPerPage = numColumns * numRows;
+	if( 0 == numCellsPerPage ) {
+		std::stringstream ss;
+		ss << "Texture size " << textureSize << " is too small for glyph cells of size " << cellSize;
+		throw std::runtime_error( ss.str() );
+	}
+
+	for( size_t i = 0; i < glyphs.size(); ++i ) {
+		const size_t cellIndex = i % numCellsPerPage;
+		if( 0 == cellIndex ) {
+			result.push_back( std::vector<RenderGlyph>() );
+			result.back().reserve( std::min( numCellsPerPage, glyphs.size() - i ) );
+		}
+		RenderGlyph renderGlyph = glyphs[i];
+		renderGlyph.position = ivec2( static_cast<int32_t>( cellIndex % numColumns ), static_cast<int32_t>( cellIndex / numColumns ) ) * cellStride;
+		result.back().push_back( renderGlyph );
+	}
+
+	return result;
+}
+
+std::vector<std::vector<RenderGlyph>> packShelves( std::vector<RenderGlyph> glyphs, const ivec2 &textureSize, const ivec2 &tileSpacing )
+{
+	// Tallest first, so that the glyphs on a shelf are of similar height. Glyphs with a priority 
+	// are packed ahead of the others to keep them on the first pages.
+	std::stable_sort( std::begin( glyphs ), std::end( glyphs ), 
+		[]( const RenderGlyph& a, const RenderGlyph& b ) -> bool { 
+			const bool aPrioritized = ( a.priority > 0.0f );
+			const bool bPrioritized = ( b.priority > 0.0f );
+			if( aPrioritized != bPrioritized ) {
+				return aPrioritized;
+			}
+			return a.bitmapSize.y > b.bitmapSize.y; 
+		}
+	);
+
+	std::vector<std::vector<RenderGlyph>> result;
+	std::vector<RenderGlyph> curRenderGlyphs;
+	ivec2 curRenderPos = ivec2( 0 );
+	int32_t shelfHeight = 0;
+	for( auto renderGlyph : glyphs ) {
+		if( ( renderGlyph.bitmapSize.x > textureSize.x ) || ( renderGlyph.bitmapSize.y > textureSize.y ) ) {
+			CI_LOG_W( "Glyph " << renderGlyph.glyphIndex << " of size " << renderGlyph.bitmapSize << " doesn't fit into texture size " << textureSize );
+			continue;
+		}
+		// Next shelf
+		if( ( curRenderPos.x + renderGlyph.bitmapSize.x ) > textureSize.x ) {
+			curRenderPos.x = 0;
+			curRenderPos.y += shelfHeight + tileSpacing.y;
+			shelfHeight = 0;
+		}
+		// Next page
+		if( ( curRenderPos.y + renderGlyph.bitmapSize.y ) > textureSize.y ) {
+			result.push_back( curRenderGlyphs );
+			curRenderGlyphs.clear();
+			curRenderPos = ivec2( 0 );
+			shelfHeight = 0;
+		}
+
+		renderGlyph.position = curRenderPos;
+		curRenderGlyphs.push_back( renderGlyph );
+		curRenderPos.x += renderGlyph.bitmapSize.x + tileSpacing.x;
+		shelfHeight = std::max( shelfHeight, renderGlyph.bitmapSize.y );
+	}
+
+	if( ! curRenderGlyphs.empty() ) {
+		result.push_back( curRenderGlyphs );
+	}
+
+	return result;
+}
+
+std::vector<std::vector<RenderGlyph>> planPages( std::vector<RenderGlyph> glyphs, bool packed, const ivec2 &cellSize, const ivec2 &textureSize, const ivec2 &tileSpacing )
+{
+	// Pages are generated and published in order, so the glyphs of the highest priority are drawable first
+	std::stable_sort( std::begin( glyphs ), std::end( glyphs ), 
+		[]( const RenderGlyph& a, const RenderGlyph& b ) -> bool { 
+			return a.priority > b.priority; 
+		}
+	);
+	return packed ? packShelves( std::move( glyphs ), textureSize, tileSpacing ) : packGrid( glyphs, cellSize, textureSize, tileSpacing );
+}
+
+ivec2 chooseTextureSize( const std::vector<RenderGlyph> &glyphs, bool packed, const ivec2 &tileSpacing, const ivec2 &maxTextureSize, const ivec2 &defaultTextureSize )
+{
+	ivec2 maxCellSize = ivec2( 1 );
+	for( const auto& glyph : glyphs ) {
+		maxCellSize = ivec2( std::max( maxCellSize.x, glyph.bitmapSize.x ), std::max( maxCellSize.y, glyph.bitmapSize.y ) );
+	}
+	const ivec2 gridCellSize = maxCellSize + tileSpacing;
+
+	// Packed glyphs can't take less than their area, so that bounds the pages of each size from below
+	uint64_t glyphArea = 0;
+	for( const auto& glyph : glyphs ) {
+		glyphArea += static_cast<uint64_t>( glyph.bitmapSize.x ) * static_cast<uint64_t>( glyph.bitmapSize.y );
+	}
+
+	struct Candidate {
+		ivec2		size;
+		size_t		minNumPages;
+		uint64_t	minNumTexels;
+	};
+	std::vector<Candidate> candidates;
+	for( int32_t width = 1; width <= maxTextureSize.x; width *= 2 ) {
+		for( int32_t height = 1; height <= maxTextureSize.y; height *= 2 ) {
+			const ivec2 size = ivec2( width, height );
+			if( ( size.x < maxCellSize.x ) || ( size.y < maxCellSize.y ) ) {
+				continue;
+			}
+
+			const uint64_t pageArea = static_cast<uint64_t>( size.x ) * static_cast<uint64_t>( size.y );
+			size_t numPages = 0;
+			if( packed ) {
+				numPages = static_cast<size_t>( ( glyphArea + pageArea - 1 ) / pageArea );
+			}
+			else {
+				const size_t numCellsPerPage = static_cast<size_t>( size.x / gridCellSize.x ) * static_cast<size_t>( size.y / gridCellSize.y );
+				if( 0 == numCellsPerPage ) {
+					continue;
+				}
+				numPages = ( glyphs.size() + numCellsPerPage - 1 ) / numCellsPerPage;
+			}
+			numPages = std::max<size_t>( numPages, 1 );
+			candidates.push_back( { size, numPages, static_cast<uint64_t>( numPages ) * pageArea } );
+		}
+	}
+
+	// Fewest pages, then fewest texels. Packing only gets worse than the bound, so once a candidate's bound 
+	// loses to the best packing found, so does every candidate after it and they aren't packed at all.
+	std::stable_sort( std::begin( candidates ), std::end( candidates ),
+		[]( const Candidate& a, const Candidate& b ) -> bool {
+			return ( a.minNumPages < b.minNumPages ) || ( ( a.minNumPages == b.minNumPages ) && ( a.minNumTexels < b.minNumTexels ) );
+		}
+	);
+
+	ivec2 result = defaultTextureSize;
+	size_t bestNumPages = std::numeric_limits<size_t>::max();
+	uint64_t bestNumTexels = std::numeric_limits<uint64_t>::max();
+	for( const auto& candidate : candidates ) {
+		if( ( candidate.minNumPages > bestNumPages ) || ( ( candidate.minNumPages == bestNumPages ) && ( candidate.minNumTexels > bestNumTexels ) ) ) {
+			break;
+		}
+
+		const ivec2 size = candidate.size;
+		size_t numPages = candidate.minNumPages;
+		if( packed ) {
+			numPages = std::max<size_t>( packShelves( glyphs, size, tileSpacing ).size(), 1 );
+		}
+
+		// Fewest pages, then fewest texels, then the squarest page
+		const uint64_t numTexels = static_cast<uint64_t>( numPages ) * static_cast<uint64_t>( size.x ) * static_cast<uint64_t>( size.y );
+		const bool better = ( numPages < bestNumPages ) ||
+							( ( numPages == bestNumPages ) && ( numTexels < bestNumTexels ) ) ||
+							( ( numPages == bestNumPages ) && ( numTexels == bestNumTexels ) && ( std::abs( size.x - size.y ) < std::abs( result.x - result.y ) ) );
+		if( better ) {
+			result = size;
+			bestNumPages = numPages;
+			bestNumTexels = numTexels;
+		}
+	}
+	return result;
+}
+
+// =================================================================================================
+// FontNameIndex
+// =================================================================================================
+static const size_t kMaxGramSize = 3;
+
+const size_t FontNameIndex::npos;
+
+static std::vector<std::string> splitTokens( const std::string &name )
+{
+	std::vector<std::string> result;
+	boost::split( result, name, boost::is_any_of( " " ), boost::token_compress_on );
+	return result;
+}
+
+void FontNameIndex::clear()
+{
+	mKeyIndex.clear();
+	mKeyLengths.clear();
+	mKeyTokenCounts.clear();
+	mTokens.clear();
+	mTokenKeys.clear();
+	mGramTokens.clear();
+}
+
+void FontNameIndex::build( const std::vector<std::string> &keys )
+{
+	clear();
+
+	std::vector<std::vector<std::string>> keyTokens;
+	for( size_t i = 0; i < keys.size(); ++i ) {
+		// Keeps the first of a key, like a linear search would
+		mKeyIndex.insert( std::make_pair( keys[i], i ) );
+		mKeyLengths.push_back( keys[i].length() );
+		keyTokens.push_back( splitTokens( keys[i] ) );
+		mKeyTokenCounts.push_back( keyTokens.back().size() );
+		mTokens.insert( std::end( mTokens ), std::begin( keyTokens.back() ), std::end( keyTokens.back() ) );
+	}
+	std::sort( std::begin( mTokens ), std::end( mTokens ) );
+	mTokens.erase( std::unique( std::begin( mTokens ), std::end( mTokens ) ), std::end( mTokens ) );
+
+	mTokenKeys.resize( mTokens.size() );
+	for( size_t i = 0; i < keyTokens.size(); ++i ) {
+		for( const auto& tok : keyTokens[i] ) {
+			const size_t tokenIndex = std::lower_bound( std::begin( mTokens ), std::end( mTokens ), tok ) - std::begin( mTokens );
+			std::vector<size_t>& tokenKeys = mTokenKeys[tokenIndex];
+			if( tokenKeys.empty() || ( tokenKeys.back() != i ) ) {
+				tokenKeys.push_back( i );
+			}
+		}
+	}
+
+	for( uint32_t tokenIndex = 0; tokenIndex < static_cast<uint32_t>( mTokens.size() ); ++tokenIndex ) {
+		const std::string& tok = mTokens[tokenIndex];
+		for( size_t gramSize = 1; ( gramSize <= kMaxGramSize ) && ( gramSize <= tok.size() ); ++gramSize ) {
+			for( size_t pos = 0; ( pos + gramSize ) <= tok.size(); ++pos ) {
+				// Tokens are visited in order, so a token repeating a substring is the last one added
+				std::vector<uint32_t>& gramTokens = mGramTokens[tok.substr( pos, gramSize )];
+				if( gramTokens.empty() || ( gramTokens.back() != tokenIndex ) ) {
+					gramTokens.push_back( tokenIndex );
+				}
+			}
+		}
+	}
+}
+
+size_t FontNameIndex::findKey( const std::string &name ) const
+{
+	auto it = mKeyIndex.find( name );
+	return ( mKeyIndex.end() != it ) ? it->second : npos;
+}
+
+void FontNameIndex::findTokens( const std::string &token, std::vector<uint32_t> *result ) const
+{
+	if( token.size() <= kMaxGramSize ) {
+		auto it = mGramTokens.find( token );
+		if( mGramTokens.end() != it ) {
+			result->insert( std::end( *result ), std::begin( it->second ), std::end( it->second ) );
+		}
+		return;
+	}
+
+	// Every token containing this one has all of its trigrams, the rarest one has the fewest to check
+	const std::vector<uint32_t> *candidates = nullptr;
+	for( size_t pos = 0; ( pos + kMaxGramSize ) <= token.size(); ++pos ) {
+		auto it = mGramTokens.find( token.substr( pos, kMaxGramSize ) );
+		if( mGramTokens.end() == it ) {
+			return;
+		}
+		if( ( nullptr == candidates ) || ( it->second.size() < candidates->size() ) ) {
+			candidates = &( it->second );
+		}
+	}
+	for( const auto& tokenIndex : *candidates ) {
+		if( std::string::npos != mTokens[tokenIndex].find( token ) ) {
+			result->push_back( tokenIndex );
+		}
+	}
+}
+
+size_t FontNameIndex::findBestMatch( const std::string &name ) const
+{
+	const std::vector<std::string> tokens = splitTokens( name );
+	// Each key counts a name token once, in key order for ties
+	std::map<size_t, size_t> hits;
+	std::vector<uint32_t> matchingTokens;
+	std::vector<size_t> tokenKeys;
+	for( const auto& tok : tokens ) {
+		if( tok.empty() ) {
+			continue;
+		}
+		matchingTokens.clear();
+		findTokens( tok, &matchingTokens );
+		tokenKeys.clear();
+		for( const auto& tokenIndex : matchingTokens ) {
+			tokenKeys.insert( std::end( tokenKeys ), std::begin( mTokenKeys[tokenIndex] ), std::end( mTokenKeys[tokenIndex] ) );
+		}
+		std::sort( std::begin( tokenKeys ), std::end( tokenKeys ) );
+		tokenKeys.erase( std::unique( std::begin( tokenKeys ), std::end( tokenKeys ) ), std::end( tokenKeys ) );
+		for( const auto& keyIndex : tokenKeys ) {
+			hits[keyIndex] += tok.size();
+		}
+	}
+
+	size_t result = npos;
+	float highScore = 0.0f;
+	for( const auto& it : hits ) {
+		const size_t numKeyTokens = mKeyTokenCounts[it.first];
+		float keyScore = ( numKeyTokens == tokens.size() ) ? 0.25f : 0.0f;
+		float hitScore = static_cast<float>( it.second ) / static_cast<float>( mKeyLengths[it.first] - ( numKeyTokens - 1 ) );
+		hitScore = 0.75f * std::min( hitScore, 1.0f );
+		float totalScore = keyScore + hitScore;
+		if( totalScore > highScore ) {
+			highScore = totalScore;
+			result = it.first;
+		}
+	}
+	return result;
+}
+
+// =================================================================================================
+// GlyphQuadBatch
+// =================================================================================================
+std::vector<GlyphQuadBatch> GlyphQuadBatch::createBatches( size_t numPages, bool textureArray )
+{
+	std::vector<GlyphQuadBatch> result( textureArray ? 1 : numPages );
+	for( auto& batch : result ) {
+		batch.mTexCoordSize = textureArray ? 3 : 2;
+	}
+	return result;
+}
+
+void GlyphQuadBatch::addQuad( const Rectf &destRect, const Rectf &srcTexCoords, uint32_t layer, const ColorA8u *color )
+{
+	const uint32_t curIdx = static_cast<uint32_t>( mVerts.size() / 2 );
+
+	mVerts.push_back( destRect.getX2() ); mVerts.push_back( destRect.getY1() );
+	mVerts.push_back( destRect.getX1() ); mVerts.push_back( destRect.getY1() );
+	mVerts.push_back( destRect.getX2() ); mVerts.push_back( destRect.getY2() );
+	mVerts.push_back( destRect.getX1() ); mVerts.push_back( destRect.getY2() );
+
+	addTexCoord( srcTexCoords.getX2(), srcTexCoords.getY1(), layer );
+	addTexCoord( srcTexCoords.getX1(), srcTexCoords.getY1(), layer );
+	addTexCoord( srcTexCoords.getX2(), srcTexCoords.getY2(), layer );
+	addTexCoord( srcTexCoords.getX1(), srcTexCoords.getY2(), layer );
+
+	if( nullptr != color ) {
+		for( int i = 0; i < 4; ++i ) {
+			mColors.push_back( *color );
+		}
+	}
+
+	mIndices.push_back( curIdx + 0 ); mIndices.push_back( curIdx + 1 ); mIndices.push_back( curIdx + 2 );
+	mIndices.push_back( curIdx + 2 ); mIndices.push_back( curIdx + 1 ); mIndices.push_back( curIdx + 3 );
+}
+
+void GlyphQuadBatch::addTexCoord( float s, float t, uint32_t layer )
+{
+	mTexCoords.push_back( s );
+	mTexCoords.push_back( t );
+	if( 3 == mTexCoordSize ) {
+		mTexCoords.push_back( static_cast<float>( layer ) );
+	}
+}
+
+void addGlyphQuad( std::vector<GlyphQuadBatch> *batches, bool textureArray, uint32_t page, const Rectf &destRect, const Rectf &srcTexCoords, const ColorA8u *color )
+{
+	const size_t batchIndex = textureArray ? 0 : page;
+	if( batchIndex >= batches->size() ) {
+		GlyphQuadBatch batch;
+		batch.mTexCoordSize = textureArray ? 3 : 2;
+		batches->resize( batchIndex + 1, batch );
+	}
+	( *batches )[batchIndex].addQuad( destRect, srcTexCoords, page, color );
+}
+
+Rectf getPageTexCoords( const Area &area, const ivec2 &pageSize )
+{
+	const vec2 size = vec2( pageSize );
+	return Rectf( area.x1 / size.x, area.y1 / size.y, area.x2 / size.x, area.y2 / size.y );
+}
+
+}}} // namespace cinder::gl::detail
@@ -0,0 +1,324 @@
+/*
+Copyright 2016 Google Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+Copyright (c) 2016, The Cinder Project, All rights reserved.
+This code is intended for use with the Cinder C++ library: http://libcinder.org
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this list of conditions and
+the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+the following disclaimer in the documentation and/or other materials provided with the distribution.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+//! Parts of SdfText that don't depend on FreeType or a GL context, so they can be tested on their own.
+//! Not part of the public interface.
+
+#include "cinder/Area.h"
+#include "cinder/Color.h"
+#include "cinder/Rect.h"
+#include "cinder/Surface.h"
+#include "cinder/Vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/functional/hash.hpp>
+
+namespace cinder { namespace gl { namespace detail {
+
+//! Atlas and font index files are a cache local to the machine, so values are written in native byte order
+template <typename T>
+void writeBinary( std::ostream &os, const T &value )
+{
+	os.write( reinterpret_cast<const char *>( &value ), sizeof( T ) );
+}
+
+template <typename T>
+bool readBinary( std::istream &is, T *value )
+{
+	is.read( reinterpret_cast<char *>( value ), sizeof( T ) );
+	return is.good();
+}
+
+void writeBinaryString( std::ostream &os, const std::string &value );
+//! Returns false if the string is longer than what's left of \a is
+bool readBinaryString( std::istream &is, std::string *value );
+//! Returns true if \a is has at least \a numBytes left, so sizes read from a corrupt file don't allocate more than the file holds
+bool hasRemainingBytes( std::istream &is, uint64_t numBytes );
+
+// =================================================================================================
+// AtlasCacheKey
+// =================================================================================================
+//! Identifies an atlas by its faces, format and the canonical (sorted, unique) set of glyph indices per face. 
+//! Everything else about an atlas, like its cell size, follows from these, so the key is built without 
+//! loading a single outline.
+struct AtlasCacheKey {
+	struct FaceKey {
+		std::string		mFamilyName;
+		std::string		mStyleName;
+		//! Header values that tell apart different versions of a font with the same names
+		uint32_t		mNumGlyphs = 0;
+		uint32_t		mUnitsPerEm = 0;
+		ivec2			mBBoxMin = ivec2( 0 );
+		ivec2			mBBoxMax = ivec2( 0 );
+		//! Sorted and unique
+		std::vector<uint32_t>	mGlyphIndices;
+
+		bool isSameFace( const FaceKey& rhs ) const {
+			return ( mFamilyName == rhs.mFamilyName ) &&
+				   ( mStyleName == rhs.mStyleName ) &&
+				   ( mNumGlyphs == rhs.mNumGlyphs ) &&
+				   ( mUnitsPerEm == rhs.mUnitsPerEm ) &&
+				   ( mBBoxMin == rhs.mBBoxMin ) &&
+				   ( mBBoxMax == rhs.mBBoxMax );
+		}
+	};
+
+	std::vector<FaceKey>	mFaces;
+	//! Maximum page size if mAutoTextureSize is set
+	ivec2					mTextureSize = ivec2( 0 );
+	bool					mAutoTextureSize = false;
+	vec2					mSdfScale = vec2( 0 );
+	ivec2					mSdfPadding = ivec2( 0 );
+	float					mSdfRange = 0.0f;
+	float					mSdfAngle = 0.0f;
+	ivec2					mSdfTileSpacing = ivec2( 0 );
+	bool					mTextureArray = false;
+	bool					mKeepCompressedPages = false;
+	bool					mDynamic = false;
+	uint32_t				mMaxPages = 0;
+	bool					mAdaptiveSdfScale = false;
+	vec2					mSdfScaleRange = vec2( 0 );
+	//! Scale of the atlas this one is derived from, zero if its glyphs were generated
+	vec2					mPyramidSdfScale = vec2( 0 );
+	//! Atlas made of the atlases of the Unicode blocks in use, these aren't written to disk
+	bool					mUnicodeBlocks = false;
+	//! Returns true if \a rhs was generated from the same faces with the same format, regardless of its glyphs
+	bool isSameFormat( const AtlasCacheKey& rhs ) const {
+		if( mFaces.size() != rhs.mFaces.size() ) {
+			return false;
+		}
+		for( size_t i = 0; i < mFaces.size(); ++i ) {
+			if( ! mFaces[i].isSameFace( rhs.mFaces[i] ) ) {
+				return false;
+			}
+		}
+		return ( mTextureSize == rhs.mTextureSize ) &&
+			   ( mAutoTextureSize == rhs.mAutoTextureSize ) &&
+			   ( mSdfScale == rhs.mSdfScale ) &&
+			   ( mSdfPadding == rhs.mSdfPadding ) &&
+			   ( mSdfRange == rhs.mSdfRange ) &&
+			   ( mSdfAngle == rhs.mSdfAngle ) &&
+			   ( mSdfTileSpacing == rhs.mSdfTileSpacing ) &&
+			   ( mTextureArray == rhs.mTextureArray ) &&
+			   ( mKeepCompressedPages == rhs.mKeepCompressedPages ) &&
+			   ( mDynamic == rhs.mDynamic ) &&
+			   ( mMaxPages == rhs.mMaxPages ) &&
+			   ( mAdaptiveSdfScale == rhs.mAdaptiveSdfScale ) &&
+			   ( mSdfScaleRange == rhs.mSdfScaleRange ) &&
+			   ( mPyramidSdfScale == rhs.mPyramidSdfScale ) &&
+			   ( mUnicodeBlocks == rhs.mUnicodeBlocks );
+	}
+	//! Returns true if every glyph of this key is also in \a rhs. Assumes isSameFormat( rhs ).
+	bool isSubsetOf( const AtlasCacheKey& rhs ) const {
+		for( size_t i = 0; i < mFaces.size(); ++i ) {
+			const auto& glyphs = mFaces[i].mGlyphIndices;
+			const auto& rhsGlyphs = rhs.mFaces[i].mGlyphIndices;
+			if( ! std::includes( std::begin( rhsGlyphs ), std::end( rhsGlyphs ), std::begin( glyphs ), std::end( glyphs ) ) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+	//! Returns the total number of glyphs over all faces
+	size_t getNumGlyphs() const {
+		size_t result = 0;
+		for( const auto& face : mFaces ) {
+			result += face.mGlyphIndices.size();
+		}
+		return result;
+	}
+	bool operator==( const AtlasCacheKey& rhs ) const { 
+		if( ! isSameFormat( rhs ) ) {
+			return false;
+		}
+		for( size_t i = 0; i < mFaces.size(); ++i ) {
+			if( mFaces[i].mGlyphIndices != rhs.mFaces[i].mGlyphIndices ) {
+				return false;
+			}
+		}
+		return true;
+	}
+	bool operator!=( const AtlasCacheKey& rhs ) const {
+		return ! ( *this == rhs );
+	}
+
+	void write( std::ostream &os ) const;
+	//! Returns false if \a is is truncated or corrupt
+	bool read( std::istream &is );
+
+	struct Hasher {
+		size_t operator()( const AtlasCacheKey& key ) const {
+			size_t result = 0;
+			for( const auto& face : key.mFaces ) {
+				boost::hash_combine( result, face.mFamilyName );
+				boost::hash_combine( result, face.mStyleName );
+				boost::hash_combine( result, face.mNumGlyphs );
+				boost::hash_range( result, std::begin( face.mGlyphIndices ), std::end( face.mGlyphIndices ) );
+			}
+			boost::hash_combine( result, key.mTextureSize.x );
+			boost::hash_combine( result, key.mTextureSize.y );
+			boost::hash_combine( result, key.mSdfScale.x );
+			boost::hash_combine( result, key.mSdfScale.y );
+			return result;
+		}
+	};
+};
+
+// =================================================================================================
+// AtlasPageCodec
+// =================================================================================================
+//! Lossless codec for RGB8 distance field pages. Every row is delta coded against the previous pixel 
+//! and the deltas are run-length encoded. Saturated areas turn into runs of zero deltas and the 
+//! linear ramps around glyph edges into runs of constant deltas, which is most of a distance field.
+//! A token byte with the high bit set is followed by one delta that repeats ( token & 0x7F ) + 1 
+//! times, otherwise by token + 1 literal deltas. Rows are independent of each other.
+class AtlasPageCodec {
+public:
+	struct Page {
+		ivec2					mSize = ivec2( 0 );
+		std::vector<uint8_t>	mData;
+	};
+
+	static Page		encode( const Surface8u &surface );
+	//! Decodes \a page into \a surface, which must have the size of the page. Returns false if the data is malformed.
+	static bool		decode( const Page &page, Surface8u *surface );
+
+private:
+	static const size_t	kMaxRun = 128;
+};
+
+// =================================================================================================
+// Atlas layout
+// =================================================================================================
+//! Glyph to be rendered at \a position of a page
+struct RenderGlyph {
+	uint32_t faceSlot = 0;
+	uint32_t glyphIndex = 0;
+	ivec2    position = ivec2( 0 );
+	vec2     sdfScale = vec2( 0 );
+	ivec2    bitmapSize = ivec2( 0 );
+	float    priority = 0.0f;
+};
+
+//! Places \a glyphs in order into a grid of \a cellSize cells on pages of \a textureSize, returns the glyphs of each page. 
+//! Throws if not even one cell fits into a page.
+std::vector<std::vector<RenderGlyph>> packGrid( const std::vector<RenderGlyph> &glyphs, const ivec2 &cellSize, const ivec2 &textureSize, const ivec2 &tileSpacing );
+//! Packs glyphs of varying size into rows of pages of \a textureSize, returns the glyphs of each page
+std::vector<std::vector<RenderGlyph>> packShelves( std::vector<RenderGlyph> glyphs, const ivec2 &textureSize, const ivec2 &tileSpacing );
+//! Sorts \a glyphs by descending priority and packs them into shelves if \a packed, otherwise into a grid of \a cellSize. 
+//! Returns the glyphs of each page in the order the pages are generated.
+std::vector<std::vector<RenderGlyph>> planPages( std::vector<RenderGlyph> glyphs, bool packed, const ivec2 &cellSize, const ivec2 &textureSize, const ivec2 &tileSpacing );
+//! Returns the power of two page size up to \a maxTextureSize that holds \a glyphs in the fewest pages, then with the fewest 
+//! texels, or \a defaultTextureSize if none does. Glyphs are packed into shelves if \a packed, otherwise into a grid of their uniform size.
+ivec2 chooseTextureSize( const std::vector<RenderGlyph> &glyphs, bool packed, const ivec2 &tileSpacing, const ivec2 &maxTextureSize, const ivec2 &defaultTextureSize );
+
+// =================================================================================================
+// FontNameIndex
+// =================================================================================================
+//! Finds fonts by their keys, lower case names whose tokens are separated by spaces. A partial name is 
+//! scored against the keys with a token that contains one of its tokens. Key tokens are found through 
+//! their 1 to 3 character substrings, longer name tokens are looked up by their rarest trigram and 
+//! checked against the tokens that have it.
+class FontNameIndex {
+public:
+	static const size_t npos = std::numeric_limits<size_t>::max();
+
+	//! Indexes \a keys, the position of a key is what the lookups return
+	void	build( const std::vector<std::string> &keys );
+	void	clear();
+
+	//! Returns the first key equal to \a name, or \c npos
+	size_t	findKey( const std::string &name ) const;
+	//! Returns the key that \a name matches best, or \c npos if no key token contains any token of \a name. 
+	//! Favors keys with as many tokens as \a name and the key that the most of is covered by \a name, the first 
+	//! of them on ties.
+	size_t	findBestMatch( const std::string &name ) const;
+
+private:
+	//! Appends the indices into mTokens of the key tokens containing \a token
+	void	findTokens( const std::string &token, std::vector<uint32_t> *result ) const;
+
+	//! First key of each name
+	std::unordered_map<std::string, size_t>		mKeyIndex;
+	std::vector<size_t>							mKeyLengths;
+	std::vector<size_t>							mKeyTokenCounts;
+	//! Distinct key tokens, sorted
+	std::vector<std::string>					mTokens;
+	//! Keys with each token of mTokens, in order
+	std::vector<std::vector<size_t>>			mTokenKeys;
+	//! Tokens containing each substring of 1 to 3 characters, in order
+	std::unordered_map<std::string, std::vector<uint32_t>>	mGramTokens;
+};
+
+// =================================================================================================
+// GlyphQuadBatch
+// =================================================================================================
+//! CPU-side geometry of the glyph quads drawn with one atlas texture (or with the whole texture 
+//! array). Building it doesn't touch GL, so page assignment and vertex generation can be run and 
+//! inspected without a context.
+struct GlyphQuadBatch {
+	std::vector<float>		mVerts;
+	std::vector<float>		mTexCoords;
+	std::vector<ColorA8u>	mColors;
+	std::vector<uint32_t>	mIndices;
+	//! 2 for texture pages, 3 for texture array pages where the layer is carried per vertex
+	int						mTexCoordSize = 2;
+
+	//! Returns a batch per atlas page, or a single batch if the atlas pages live in a texture array
+	static std::vector<GlyphQuadBatch> createBatches( size_t numPages, bool textureArray );
+
+	bool	empty() const { return mIndices.empty(); }
+	//! Adds the quad \a destRect showing \a srcTexCoords of \a layer, which is only stored for texture array pages. Colors are optional but must be given for every quad or none.
+	void	addQuad( const Rectf &destRect, const Rectf &srcTexCoords, uint32_t layer, const ColorA8u *color );
+
+private:
+	void	addTexCoord( float s, float t, uint32_t layer );
+};
+
+//! Adds a glyph quad on \a page to the batch of that page, or to the only batch of a texture array, see GlyphQuadBatch::createBatches(). 
+//! Batches are added for pages past the end, which loading a Unicode block adds during a draw.
+void addGlyphQuad( std::vector<GlyphQuadBatch> *batches, bool textureArray, uint32_t page, const Rectf &destRect, const Rectf &srcTexCoords, const ColorA8u *color );
+
+//! Returns the normalized texture coordinates of \a area on a page of \a pageSize. Pages are uploaded from Surfaces, 2D textures and 
+//! texture array layers alike, so the first row of a page is at t = 0 and \a area maps to [x / width, y / height] without a flip.
+Rectf getPageTexCoords( const Area &area, const ivec2 &pageSize );
+
+}}} // namespace cinder::gl::detail
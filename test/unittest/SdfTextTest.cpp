@@ -0,0 +1,559 @@
+// CPU-only tests of the SdfText internals in src/cinder/gl/SdfTextInternal.h. Needs no GL context.
+
+#include "catch.hpp"
+
+#include "cinder/gl/SdfTextInternal.h"
+#include "cinder/Timer.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "msdfgen/msdfgen.h"
+#include "msdfgen/util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <sstream>
+
+using namespace ci;
+using namespace ci::gl::detail;
+
+static AtlasCacheKey createCacheKey()
+{
+	AtlasCacheKey result;
+	AtlasCacheKey::FaceKey face;
+	face.mFamilyName = "Test Sans";
+	face.mStyleName = "Regular";
+	face.mNumGlyphs = 512;
+	face.mUnitsPerEm = 2048;
+	face.mBBoxMin = ivec2( -100, -400 );
+	face.mBBoxMax = ivec2( 2000, 1900 );
+	face.mGlyphIndices = { 3, 4, 5, 36, 68, 300 };
+	result.mFaces.push_back( face );
+	result.mTextureSize = ivec2( 1024, 512 );
+	result.mAutoTextureSize = true;
+	result.mSdfScale = vec2( 1.5f );
+	result.mSdfPadding = ivec2( 2 );
+	result.mSdfRange = 2.0f;
+	result.mSdfAngle = 3.0f;
+	result.mSdfTileSpacing = ivec2( 1 );
+	result.mMaxPages = 4;
+	result.mSdfScaleRange = vec2( 0.5f, 2.0f );
+	result.mPyramidSdfScale = vec2( 3.0f );
+	return result;
+}
+
+TEST_CASE( "SdfText AtlasCacheKey", "[sdftext]" )
+{
+	const AtlasCacheKey key = createCacheKey();
+	const AtlasCacheKey::Hasher hasher;
+
+	SECTION( "equal keys" ) {
+		const AtlasCacheKey other = createCacheKey();
+		REQUIRE( other == key );
+		REQUIRE( hasher( other ) == hasher( key ) );
+	}
+
+	SECTION( "format fields" ) {
+		AtlasCacheKey other = key;
+		other.mSdfRange = 4.0f;
+		REQUIRE_FALSE( other.isSameFormat( key ) );
+		REQUIRE( other != key );
+
+		other = key;
+		other.mFaces[0].mUnitsPerEm = 1000;
+		REQUIRE_FALSE( other.isSameFormat( key ) );
+		REQUIRE( other != key );
+	}
+
+	SECTION( "glyph subsets" ) {
+		AtlasCacheKey subset = key;
+		subset.mFaces[0].mGlyphIndices = { 4, 36, 300 };
+		REQUIRE( subset.isSameFormat( key ) );
+		REQUIRE( subset != key );
+		REQUIRE( subset.isSubsetOf( key ) );
+		REQUIRE_FALSE( key.isSubsetOf( subset ) );
+		REQUIRE( subset.getNumGlyphs() == 3 );
+
+		AtlasCacheKey other = key;
+		other.mFaces[0].mGlyphIndices.push_back( 301 );
+		REQUIRE_FALSE( other.isSubsetOf( key ) );
+	}
+}
+
+TEST_CASE( "SdfText AtlasCacheKey read/write", "[sdftext]" )
+{
+	const AtlasCacheKey key = createCacheKey();
+	std::stringstream ss( std::ios::in | std::ios::out | std::ios::binary );
+	key.write( ss );
+
+	SECTION( "round trip" ) {
+		AtlasCacheKey readKey;
+		REQUIRE( readKey.read( ss ) );
+		REQUIRE( readKey == key );
+	}
+
+	SECTION( "every field is stored" ) {
+		AtlasCacheKey other = key;
+		other.mMaxPages = 8;
+		std::stringstream otherSs( std::ios::in | std::ios::out | std::ios::binary );
+		other.write( otherSs );
+		AtlasCacheKey readKey;
+		REQUIRE( readKey.read( otherSs ) );
+		REQUIRE( readKey != key );
+	}
+
+	SECTION( "truncated file" ) {
+		const std::string data = ss.str();
+		std::stringstream truncated( data.substr( 0, data.size() - 3 ), std::ios::in | std::ios::binary );
+		AtlasCacheKey readKey;
+		REQUIRE_FALSE( readKey.read( truncated ) );
+	}
+
+	SECTION( "counts larger than the file" ) {
+		std::stringstream corrupt( std::ios::in | std::ios::out | std::ios::binary );
+		writeBinary( corrupt, std::numeric_limits<uint32_t>::max() );
+		AtlasCacheKey readKey;
+		REQUIRE_FALSE( readKey.read( corrupt ) );
+	}
+}
+
+static bool isSameSurface( const Surface8u &a, const Surface8u &b )
+{
+	if( a.getSize() != b.getSize() ) {
+		return false;
+	}
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		const uint8_t *rowA = a.getData() + y * a.getRowBytes();
+		const uint8_t *rowB = b.getData() + y * b.getRowBytes();
+		for( int32_t x = 0; x < a.getWidth(); ++x ) {
+			const uint8_t *pixelA = rowA + x * a.getPixelInc();
+			const uint8_t *pixelB = rowB + x * b.getPixelInc();
+			if( ( pixelA[0] != pixelB[0] ) || ( pixelA[1] != pixelB[1] ) || ( pixelA[2] != pixelB[2] ) ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TEST_CASE( "SdfText AtlasPageCodec", "[sdftext]" )
+{
+	// Saturated areas, ramps and noise, like the inside, edges and corners of a distance field
+	Surface8u surface( 67, 31, false );
+	for( int32_t y = 0; y < surface.getHeight(); ++y ) {
+		uint8_t *row = surface.getData() + y * surface.getRowBytes();
+		for( int32_t x = 0; x < surface.getWidth(); ++x ) {
+			uint8_t *pixel = row + x * surface.getPixelInc();
+			pixel[0] = ( x < 20 ) ? 0 : 255;
+			pixel[1] = static_cast<uint8_t>( 4 * x + y );
+			pixel[2] = static_cast<uint8_t>( ( x * 7919 + y * 104729 ) >> 3 );
+		}
+	}
+
+	const AtlasPageCodec::Page page = AtlasPageCodec::encode( surface );
+	REQUIRE( page.mSize == surface.getSize() );
+
+	SECTION( "round trip" ) {
+		Surface8u decoded( surface.getWidth(), surface.getHeight(), false );
+		REQUIRE( AtlasPageCodec::decode( page, &decoded ) );
+		REQUIRE( isSameSurface( decoded, surface ) );
+	}
+
+	SECTION( "truncated data" ) {
+		AtlasPageCodec::Page truncated = page;
+		truncated.mData.resize( truncated.mData.size() / 2 );
+		Surface8u decoded( surface.getWidth(), surface.getHeight(), false );
+		REQUIRE_FALSE( AtlasPageCodec::decode( truncated, &decoded ) );
+	}
+
+	SECTION( "size mismatch" ) {
+		Surface8u decoded( surface.getWidth() + 1, surface.getHeight(), false );
+		REQUIRE_FALSE( AtlasPageCodec::decode( page, &decoded ) );
+	}
+}
+
+// Renders the printable ASCII and Latin-1 glyphs of the bundled Roboto into pages laid out like a 
+// static atlas with the default Format, then reports how well AtlasPageCodec does on them. Hidden, 
+// run it with: SdfTextTest "[benchmark]"
+TEST_CASE( "SdfText AtlasPageCodec on Roboto pages", "[.][benchmark]" )
+{
+	// Format defaults
+	const vec2 sdfScale = vec2( 2.0f );
+	const ivec2 sdfPadding = ivec2( 2 );
+	const double sdfRange = 4.0;
+	const double sdfAngle = 3.0;
+	const ivec2 tileSpacing = ivec2( 1 );
+	const ivec2 textureSize = ivec2( 1024 );
+
+	FT_Library library = nullptr;
+	REQUIRE( 0 == FT_Init_FreeType( &library ) );
+	FT_Face face = nullptr;
+	REQUIRE( 0 == FT_New_Face( library, SDFTEXT_TEST_FONT_PATH, 0, &face ) );
+
+	struct Glyph {
+		msdfgen::Shape	mShape;
+		vec2			mOrigin;
+	};
+	std::vector<Glyph> glyphs;
+	vec2 maxGlyphSize = vec2( 0 );
+	for( uint32_t ch = 32; ch < 256; ++ch ) {
+		const FT_UInt glyphIndex = FT_Get_Char_Index( face, ch );
+		Glyph glyph;
+		if( ( ( ch >= 127 ) && ( ch < 160 ) ) || ( 0 == glyphIndex ) || ( ! msdfgen::loadGlyph( glyph.mShape, face, glyphIndex ) ) ) {
+			continue;
+		}
+		double l = 0.0, b = 0.0, r = 0.0, t = 0.0;
+		glyph.mShape.bounds( l, b, r, t );
+		glyph.mOrigin = vec2( l, b );
+		maxGlyphSize = vec2( std::max( maxGlyphSize.x, static_cast<float>( r - l ) ), std::max( maxGlyphSize.y, static_cast<float>( t - b ) ) );
+		glyphs.push_back( std::move( glyph ) );
+	}
+	FT_Done_Face( face );
+	FT_Done_FreeType( library );
+	REQUIRE( glyphs.size() > 150 );
+
+	// One cell size for every glyph, see TextureAtlas::calculateSdfBitmapSize()
+	const ivec2 cellSize = ivec2( ( sdfScale * ( maxGlyphSize + ( 2.0f * vec2( sdfPadding ) ) ) ) + vec2( 0.5f ) );
+	const int32_t numColumns = textureSize.x / ( cellSize.x + tileSpacing.x );
+	const int32_t numRows = textureSize.y / ( cellSize.y + tileSpacing.y );
+	REQUIRE( numColumns * numRows > 0 );
+
+	std::vector<Surface8u> surfaces;
+	for( size_t i = 0; i < glyphs.size(); ++i ) {
+		const int32_t cellIndex = static_cast<int32_t>( i ) % ( numColumns * numRows );
+		if( 0 == cellIndex ) {
+			surfaces.push_back( Surface8u( textureSize.x, textureSize.y, false ) );
+			std::fill( surfaces.back().getData(), surfaces.back().getData() + textureSize.y * surfaces.back().getRowBytes(), uint8_t( 0 ) );
+		}
+
+		msdfgen::Shape &shape = glyphs[i].mShape;
+		shape.inverseYAxis = true;
+		shape.normalize();
+		msdfgen::edgeColoringSimple( shape, sdfAngle );
+		const double tx = sdfPadding.x;
+		const double ty = std::fabs( glyphs[i].mOrigin.y ) + sdfPadding.y;
+		msdfgen::Bitmap<msdfgen::FloatRGB> bitmap( cellSize.x, cellSize.y );
+		msdfgen::generateMSDF( bitmap, shape, sdfRange, msdfgen::Vector2( sdfScale.x, sdfScale.y ), msdfgen::Vector2( tx, ty ) );
+
+		// Quantized the way the atlas does it, see quantizeSdfChannel()
+		auto quantize = []( float v ) -> uint8_t {
+			v = ( v > 0.0f ) ? ( ( v < 1.0f ) ? v : 1.0f ) : 0.0f;
+			return static_cast<uint8_t>( v * 255.0f );
+		};
+		Surface8u &surface = surfaces.back();
+		const ivec2 position = ivec2( cellIndex % numColumns, cellIndex / numColumns ) * ( cellSize + tileSpacing );
+		for( int32_t y = 0; y < cellSize.y; ++y ) {
+			uint8_t *dst = surface.getData() + ( position.y + y ) * surface.getRowBytes() + position.x * surface.getPixelInc();
+			for( int32_t x = 0; x < cellSize.x; ++x, dst += surface.getPixelInc() ) {
+				const msdfgen::FloatRGB &texel = bitmap( x, y );
+				dst[0] = quantize( texel.r );
+				dst[1] = quantize( texel.g );
+				dst[2] = quantize( texel.b );
+			}
+		}
+	}
+
+	size_t rawBytes = 0;
+	size_t compressedBytes = 0;
+	double decodeSeconds = 0.0;
+	for( const auto& surface : surfaces ) {
+		const AtlasPageCodec::Page page = AtlasPageCodec::encode( surface );
+		Surface8u decoded( surface.getWidth(), surface.getHeight(), false );
+		Timer timer( true );
+		REQUIRE( AtlasPageCodec::decode( page, &decoded ) );
+		decodeSeconds += timer.getSeconds();
+		REQUIRE( isSameSurface( decoded, surface ) );
+
+		rawBytes += 3 * static_cast<size_t>( surface.getWidth() ) * static_cast<size_t>( surface.getHeight() );
+		compressedBytes += page.mData.size();
+	}
+
+	std::cout << "Roboto-Regular, " << glyphs.size() << " glyphs in " << surfaces.size() << " page(s) of " << textureSize.x << "x" << textureSize.y << " with " << cellSize.x << "x" << cellSize.y << " cells" << std::endl;
+	std::cout << "  compressed/raw: " << compressedBytes << " / " << rawBytes << " = " << ( static_cast<double>( compressedBytes ) / static_cast<double>( rawBytes ) ) << std::endl;
+	std::cout << "  decode: " << ( 1000.0 * decodeSeconds ) << " ms" << std::endl;
+}
+
+static bool isValidPage( const std::vector<RenderGlyph> &page, const ivec2 &textureSize )
+{
+	for( size_t i = 0; i < page.size(); ++i ) {
+		const Area a( page[i].position, page[i].position + page[i].bitmapSize );
+		if( ( a.x1 < 0 ) || ( a.y1 < 0 ) || ( a.x2 > textureSize.x ) || ( a.y2 > textureSize.y ) ) {
+			return false;
+		}
+		for( size_t j = i + 1; j < page.size(); ++j ) {
+			const Area b( page[j].position, page[j].position + page[j].bitmapSize );
+			const bool overlap = ( a.x1 < b.x2 ) && ( b.x1 < a.x2 ) && ( a.y1 < b.y2 ) && ( b.y1 < a.y2 );
+			if( overlap ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+TEST_CASE( "SdfText packShelves", "[sdftext]" )
+{
+	const ivec2 textureSize = ivec2( 64, 64 );
+	const ivec2 tileSpacing = ivec2( 1, 1 );
+	std::vector<RenderGlyph> glyphs;
+	for( uint32_t i = 0; i < 40; ++i ) {
+		RenderGlyph glyph;
+		glyph.glyphIndex = i;
+		glyph.bitmapSize = ivec2( 5 + ( i * 7 ) % 13, 6 + ( i * 5 ) % 17 );
+		glyphs.push_back( glyph );
+	}
+	glyphs[39].priority = 1.0f;
+
+	const auto pages = packShelves( glyphs, textureSize, tileSpacing );
+	REQUIRE( pages.size() > 1 );
+	REQUIRE( pages[0][0].glyphIndex == 39 );
+
+	size_t numGlyphs = 0;
+	for( const auto& page : pages ) {
+		numGlyphs += page.size();
+		REQUIRE( isValidPage( page, textureSize ) );
+	}
+	REQUIRE( numGlyphs == glyphs.size() );
+}
+
+TEST_CASE( "SdfText packGrid", "[sdftext]" )
+{
+	const ivec2 cellSize = ivec2( 10, 12 );
+	const ivec2 tileSpacing = ivec2( 1, 1 );
+	std::vector<RenderGlyph> glyphs( 20 );
+	for( uint32_t i = 0; i < glyphs.size(); ++i ) {
+		glyphs[i].glyphIndex = i;
+		glyphs[i].bitmapSize = cellSize;
+	}
+
+	SECTION( "fills pages in order" ) {
+		// 3 columns and 2 rows per page
+		const ivec2 textureSize = ivec2( 34, 26 );
+		const auto pages = packGrid( glyphs, cellSize, textureSize, tileSpacing );
+		REQUIRE( pages.size() == 4 );
+		REQUIRE( pages[0].size() == 6 );
+		REQUIRE( pages[3].size() == 2 );
+		REQUIRE( pages[0][4].glyphIndex == 4 );
+		REQUIRE( pages[0][4].position == ivec2( 11, 13 ) );
+		REQUIRE( pages[1][0].glyphIndex == 6 );
+		REQUIRE( pages[1][0].position == ivec2( 0, 0 ) );
+		for( const auto& page : pages ) {
+			REQUIRE( isValidPage( page, textureSize ) );
+		}
+	}
+
+	SECTION( "cells larger than the page" ) {
+		REQUIRE_THROWS_AS( packGrid( glyphs, cellSize, ivec2( 8, 64 ), tileSpacing ), std::runtime_error );
+		REQUIRE_THROWS_AS( packGrid( glyphs, cellSize, ivec2( 64, 0 ), tileSpacing ), std::runtime_error );
+	}
+
+	SECTION( "no glyphs" ) {
+		REQUIRE( packGrid( std::vector<RenderGlyph>(), cellSize, ivec2( 8, 8 ), tileSpacing ).empty() );
+	}
+}
+
+TEST_CASE( "SdfText planPages", "[sdftext]" )
+{
+	const ivec2 cellSize = ivec2( 10, 12 );
+	const ivec2 tileSpacing = ivec2( 1, 1 );
+	// 3 columns and 2 rows per page
+	const ivec2 textureSize = ivec2( 34, 26 );
+	std::vector<RenderGlyph> glyphs( 20 );
+	for( uint32_t i = 0; i < glyphs.size(); ++i ) {
+		glyphs[i].glyphIndex = i;
+		glyphs[i].bitmapSize = ivec2( cellSize.x, 4 + i % 9 );
+	}
+	// Pages are generated in order, so these are drawable first
+	glyphs[17].priority = 2.0f;
+	glyphs[5].priority = 1.0f;
+	glyphs[12].priority = 1.0f;
+	glyphs[19].priority = 0.5f;
+
+	SECTION( "grid" ) {
+		const auto pages = planPages( glyphs, false, cellSize, textureSize, tileSpacing );
+		REQUIRE( pages.size() == 4 );
+		REQUIRE( pages[0].size() == 6 );
+		REQUIRE( pages[0][0].glyphIndex == 17 );
+		REQUIRE( pages[0][1].glyphIndex == 5 );
+		REQUIRE( pages[0][2].glyphIndex == 12 );
+		REQUIRE( pages[0][3].glyphIndex == 19 );
+		// The others follow in their original order
+		REQUIRE( pages[0][4].glyphIndex == 0 );
+		REQUIRE( pages[3].back().glyphIndex == 18 );
+	}
+
+	SECTION( "shelves" ) {
+		const auto pages = planPages( glyphs, true, cellSize, textureSize, tileSpacing );
+		REQUIRE( pages.size() > 1 );
+		std::set<uint32_t> firstPage;
+		for( const auto& glyph : pages[0] ) {
+			firstPage.insert( glyph.glyphIndex );
+		}
+		REQUIRE( firstPage.count( 17 ) == 1 );
+		REQUIRE( firstPage.count( 5 ) == 1 );
+		REQUIRE( firstPage.count( 12 ) == 1 );
+		REQUIRE( firstPage.count( 19 ) == 1 );
+
+		size_t numGlyphs = 0;
+		for( const auto& page : pages ) {
+			numGlyphs += page.size();
+			REQUIRE( isValidPage( page, textureSize ) );
+		}
+		REQUIRE( numGlyphs == glyphs.size() );
+	}
+}
+
+TEST_CASE( "SdfText chooseTextureSize", "[sdftext]" )
+{
+	const ivec2 tileSpacing = ivec2( 1, 1 );
+	const ivec2 maxTextureSize = ivec2( 1024 );
+	const ivec2 defaultTextureSize = ivec2( 256 );
+	RenderGlyph cell;
+	cell.bitmapSize = ivec2( 30, 40 );
+
+	SECTION( "grid" ) {
+		// 90 cells of 31x41 fit on one page of 256x512 (8x12 cells) but not of 256x256 (8x6 cells). 512x256 
+		// (16x6 cells) holds them with as many texels, but the taller page comes first.
+		const std::vector<RenderGlyph> glyphs( 90, cell );
+		REQUIRE( chooseTextureSize( glyphs, false, tileSpacing, maxTextureSize, defaultTextureSize ) == ivec2( 256, 512 ) );
+	}
+
+	SECTION( "limited by the maximum size" ) {
+		const std::vector<RenderGlyph> glyphs( 90, cell );
+		const ivec2 size = chooseTextureSize( glyphs, false, tileSpacing, ivec2( 128 ), defaultTextureSize );
+		REQUIRE( size == ivec2( 128 ) );
+	}
+
+	SECTION( "no page fits a cell" ) {
+		const std::vector<RenderGlyph> glyphs( 1, cell );
+		REQUIRE( chooseTextureSize( glyphs, false, tileSpacing, ivec2( 16 ), defaultTextureSize ) == defaultTextureSize );
+	}
+
+	SECTION( "packed" ) {
+		std::vector<RenderGlyph> glyphs;
+		for( uint32_t i = 0; i < 60; ++i ) {
+			RenderGlyph glyph;
+			glyph.bitmapSize = ivec2( 8 + ( i * 7 ) % 23, 10 + ( i * 5 ) % 29 );
+			glyphs.push_back( glyph );
+		}
+		const ivec2 size = chooseTextureSize( glyphs, true, tileSpacing, maxTextureSize, defaultTextureSize );
+		REQUIRE( packShelves( glyphs, size, tileSpacing ).size() == 1 );
+		// Nothing with fewer texels holds them on one page
+		const ivec2 halves[] = { ivec2( size.x / 2, size.y ), ivec2( size.x, size.y / 2 ) };
+		for( const auto& half : halves ) {
+			REQUIRE( packShelves( glyphs, half, tileSpacing ).size() > 1 );
+		}
+	}
+}
+
+TEST_CASE( "SdfText FontNameIndex", "[sdftext]" )
+{
+	FontNameIndex index;
+	index.build( { "arial", "arial bold", "dejavu sans mono", "dejavu sans", "arial" } );
+
+	SECTION( "exact names" ) {
+		REQUIRE( index.findKey( "arial" ) == 0 );
+		REQUIRE( index.findKey( "dejavu sans mono" ) == 2 );
+		REQUIRE( index.findKey( "arial bol" ) == FontNameIndex::npos );
+	}
+
+	SECTION( "partial names" ) {
+		// Matches more of "arial bold" with the same number of words
+		REQUIRE( index.findBestMatch( "arial bol" ) == 1 );
+		// A word found in several keys goes to the key it covers the most of
+		REQUIRE( index.findBestMatch( "sans" ) == 3 );
+		// Tokens of up to three characters come straight from the substring index
+		REQUIRE( index.findBestMatch( "dej san mon" ) == 2 );
+		REQUIRE( index.findBestMatch( "b" ) == 1 );
+		// Longer ones are checked against the tokens with their rarest trigram
+		REQUIRE( index.findBestMatch( "javu" ) == 3 );
+		REQUIRE( index.findBestMatch( "rial" ) == 0 );
+	}
+
+	SECTION( "no match" ) {
+		REQUIRE( index.findBestMatch( "zzz" ) == FontNameIndex::npos );
+		// Every trigram is in the index, but no token has all of them in a row
+		REQUIRE( index.findBestMatch( "ansmon" ) == FontNameIndex::npos );
+		REQUIRE( index.findBestMatch( "" ) == FontNameIndex::npos );
+	}
+
+	SECTION( "rebuilt" ) {
+		index.build( { "roboto" } );
+		REQUIRE( index.findKey( "arial" ) == FontNameIndex::npos );
+		REQUIRE( index.findBestMatch( "robo" ) == 0 );
+		REQUIRE( index.findBestMatch( "arial" ) == FontNameIndex::npos );
+	}
+}
+
+TEST_CASE( "SdfText GlyphQuadBatch", "[sdftext]" )
+{
+	const ivec2 pageSize = ivec2( 256, 128 );
+	const Area cell = Area( 32, 16, 64, 48 );
+	const Rectf texCoords = getPageTexCoords( cell, pageSize );
+	const Rectf destRect = Rectf( 10.0f, 20.0f, 42.0f, 52.0f );
+	const ColorA8u color = ColorA8u{ 255, 128, 0, 255 };
+
+	SECTION( "tex coords" ) {
+		// Top-down, the first row of a page is at t = 0
+		REQUIRE( texCoords.x1 == 0.125f );
+		REQUIRE( texCoords.y1 == 0.125f );
+		REQUIRE( texCoords.x2 == 0.25f );
+		REQUIRE( texCoords.y2 == 0.375f );
+	}
+
+	SECTION( "texture pages" ) {
+		std::vector<GlyphQuadBatch> batches = GlyphQuadBatch::createBatches( 2, false );
+		REQUIRE( batches.size() == 2 );
+		addGlyphQuad( &batches, false, 1, destRect, texCoords, nullptr );
+		REQUIRE( batches[0].empty() );
+		REQUIRE_FALSE( batches[1].empty() );
+
+		const GlyphQuadBatch &batch = batches[1];
+		REQUIRE( batch.mTexCoordSize == 2 );
+		REQUIRE( batch.mVerts.size() == 8 );
+		REQUIRE( batch.mTexCoords.size() == 8 );
+		REQUIRE( batch.mColors.empty() );
+		REQUIRE( batch.mIndices == std::vector<uint32_t>( { 0, 1, 2, 2, 1, 3 } ) );
+		// Each corner of the quad gets the same corner of the cell
+		const float expectedVerts[] = { 42.0f, 20.0f, 10.0f, 20.0f, 42.0f, 52.0f, 10.0f, 52.0f };
+		const float expectedTexCoords[] = { 0.25f, 0.125f, 0.125f, 0.125f, 0.25f, 0.375f, 0.125f, 0.375f };
+		for( size_t i = 0; i < 8; ++i ) {
+			REQUIRE( batch.mVerts[i] == expectedVerts[i] );
+			REQUIRE( batch.mTexCoords[i] == expectedTexCoords[i] );
+		}
+	}
+
+	SECTION( "pages added during the draw" ) {
+		std::vector<GlyphQuadBatch> batches = GlyphQuadBatch::createBatches( 1, false );
+		addGlyphQuad( &batches, false, 3, destRect, texCoords, &color );
+		addGlyphQuad( &batches, false, 3, destRect, texCoords, &color );
+		REQUIRE( batches.size() == 4 );
+		REQUIRE( batches[3].mTexCoordSize == 2 );
+		REQUIRE( batches[3].mColors.size() == 8 );
+		REQUIRE( batches[3].mIndices.size() == 12 );
+		REQUIRE( batches[3].mIndices[6] == 4 );
+	}
+
+	SECTION( "texture array" ) {
+		std::vector<GlyphQuadBatch> batches = GlyphQuadBatch::createBatches( 4, true );
+		REQUIRE( batches.size() == 1 );
+		addGlyphQuad( &batches, true, 0, destRect, texCoords, nullptr );
+		addGlyphQuad( &batches, true, 5, destRect, texCoords, nullptr );
+		REQUIRE( batches.size() == 1 );
+
+		// The layer is the third coordinate, the first two match a 2D page
+		const GlyphQuadBatch &batch = batches[0];
+		REQUIRE( batch.mTexCoordSize == 3 );
+		REQUIRE( batch.mTexCoords.size() == 24 );
+		for( size_t corner = 0; corner < 8; ++corner ) {
+			const float layer = ( corner < 4 ) ? 0.0f : 5.0f;
+			REQUIRE( batch.mTexCoords[corner * 3 + 2] == layer );
+		}
+		REQUIRE( batch.mTexCoords[12] == 0.25f );
+		REQUIRE( batch.mTexCoords[13] == 0.125f );
+	}
+}